@@ -142,19 +142,101 @@ namespace e57
    /// @brief Default checksum policies for e57::ReadChecksumPolicy
    /// @details These are some convenient default checksum policies, though you can use any value
    /// you want (0-100).
+   ///
+   /// ChecksumBackground is a special value: all checksums are verified, but on a separate
+   /// thread. Data is returned as soon as it is read, and a bad checksum is reported as an
+   /// ErrorBadChecksum exception by the next read from the file or when the ImageFile is closed.
+   /// Destructors can't throw, so close the file explicitly to be sure a failure is reported.
    enum ChecksumPolicy
    {
       ChecksumNone = 0,    ///< Do not verify the checksums. (fast)
       ChecksumSparse = 25, ///< Only verify 25% of the checksums. The last block is always verified.
       ChecksumHalf = 50,   ///< Only verify 50% of the checksums. The last block is always verified.
-      ChecksumAll = 100    ///< Verify all checksums. This is the default. (slow)
+      ChecksumAll = 100,   ///< Verify all checksums. This is the default. (slow)
+
+      /// Verify all checksums on a background thread and report failures later. (see above)
+      ChecksumBackground = 101
    };
 
    /// @brief Specifies the percentage of checksums which are verified when reading an ImageFile
-   /// (0-100%).
+   /// (0-100%), or ChecksumBackground.
    /// @see e57::ChecksumPolicy
    using ReadChecksumPolicy = int;
 
+   /// @brief Specifies how the contents of an ImageFile opened for reading are accessed
+   enum ReadMethod
+   {
+      ReadMethodStream = 0,   ///< Read the file using system read calls. This is the default.
+      ReadMethodMemoryMap = 1 ///< Memory-map the file and read directly from the mapping. Falls
+                              ///< back to ReadMethodStream if the file cannot be mapped.
+   };
+
+   /// @brief Interface for reading & writing the bytes of an E57 file stored somewhere other than
+   /// a file on disk
+   /// @details Implement this to give ImageFile, Reader, or Writer access to data in a cache,
+   /// a container, over the network, etc. without copying it into memory first.
+   ///
+   /// Offsets and sizes are in bytes of the raw E57 file (including page checksums).
+   /// The library only accesses an IODevice from one thread at a time.
+   class E57_DLL IODevice
+   {
+   public:
+      virtual ~IODevice() = default;
+
+      /// @brief Read up to @a count bytes starting at @a offset into @a buffer
+      /// @returns The number of bytes read (which may be fewer than requested), or a negative
+      /// number on error.
+      virtual int64_t readAt( uint64_t offset, char *buffer, size_t count ) = 0;
+
+      /// @brief Write up to @a count bytes from @a buffer starting at @a offset
+      /// @details Only needed for writing. The default implementation fails.
+      /// @returns The number of bytes written (which may be fewer than requested), or a negative
+      /// number on error.
+      virtual int64_t writeAt( uint64_t offset, const char *buffer, size_t count );
+
+      /// @brief Returns the size of the data in bytes
+      virtual uint64_t size() const = 0;
+
+      /// @brief Change the size of the data to @a newSize bytes
+      /// @details Only needed for writing. Any bytes added must read as zeros. The default
+      /// implementation fails.
+      /// @returns true on success.
+      virtual bool resize( uint64_t newSize );
+   };
+
+   /// @brief Counters describing the I/O done by an ImageFile
+   /// @details Use these to tell whether reading or writing a file is limited by I/O, by
+   /// checksums, or by something else (such as decoding). They cover everything done since the
+   /// ImageFile was opened.
+   /// @see ImageFile::ioStatistics()
+   struct E57_DLL IOStatistics
+   {
+      /// Number of read calls made to the OS (or IODevice)
+      uint64_t readCalls = 0;
+      /// Number of write and resize calls made to the OS (or IODevice)
+      uint64_t writeCalls = 0;
+
+      /// Number of physical pages (1024 bytes each, including the checksum) read
+      uint64_t pagesRead = 0;
+      /// Number of physical pages written
+      uint64_t pagesWritten = 0;
+
+      /// Number of bytes copied from one buffer to another in memory
+      uint64_t bytesCopied = 0;
+
+      /// Number of page checksums verified
+      uint64_t pagesVerified = 0;
+      /// Number of pages read without verifying their checksum (already verified, or skipped
+      /// because of the ReadChecksumPolicy)
+      uint64_t pagesNotVerified = 0;
+
+      /// Time spent calculating checksums, including on the ChecksumBackground thread
+      uint64_t checksumNanoseconds = 0;
+      /// Time spent waiting for the OS (or IODevice) to read or write. Reads done in the
+      /// background (prefetching) only count if we had to wait for them.
+      uint64_t ioNanoseconds = 0;
+   };
+
    /// @name Deprecated Checksum Policies
    /// These have been replaced by the enum e57::ChecksumPolicy.
    ///@{
@@ -426,7 +508,12 @@ public:
 
       unsigned read();
       unsigned read( std::vector<SourceDestBuffer> &dbufs );
-      void seek( int64_t recordNumber ); // !!! not implemented yet
+      unsigned read( uint64_t startRecord, size_t count );
+      void seek( int64_t recordNumber );
+      void setPacketCacheSize( unsigned packetCount );
+      unsigned packetCacheSize() const;
+      void setDecodeThreadCount( unsigned threadCount );
+      unsigned decodeThreadCount() const;
       void close();
       bool isOpen();
       CompressedVectorNode compressedVectorNode() const;
@@ -488,6 +575,7 @@ public:
       // Iterators
       CompressedVectorWriter writer( std::vector<SourceDestBuffer> &sbufs );
       CompressedVectorReader reader( const std::vector<SourceDestBuffer> &dbufs );
+      uint64_t readParallel( std::vector<SourceDestBuffer> &dbufs, unsigned threadCount = 0 );
 
       // Up/Down cast conversion
       operator Node() const;
@@ -733,8 +821,12 @@ public:
       ImageFile() = delete;
       ImageFile( const ustring &fname, const ustring &mode,
                  ReadChecksumPolicy checksumPolicy = ChecksumAll );
+      ImageFile( const ustring &fname, const ustring &mode, ReadChecksumPolicy checksumPolicy,
+                 ReadMethod readMethod );
       ImageFile( const char *input, uint64_t size,
                  ReadChecksumPolicy checksumPolicy = ChecksumAll );
+      ImageFile( std::shared_ptr<IODevice> device, const ustring &mode,
+                 ReadChecksumPolicy checksumPolicy = ChecksumAll );
 
       StructureNode root() const;
       void close();
@@ -744,6 +836,7 @@ public:
       ustring fileName() const;
       int writerCount() const;
       int readerCount() const;
+      IOStatistics ioStatistics() const;
 
       // Manipulate registered extensions in the file
       void extensionsAdd( const ustring &prefix, const ustring &uri );
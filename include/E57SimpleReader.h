@@ -43,7 +43,22 @@ namespace e57
    struct E57_DLL ReaderOptions
    {
       /// Set how frequently to verify the checksums (see ReadChecksumPolicy).
+      /// With ChecksumBackground, a bad checksum is reported by a later read or by Close(). It is
+      /// not reported if the Reader is destroyed without calling Close().
       ReadChecksumPolicy checksumPolicy = ChecksumAll;
+
+      /// Set how the file is accessed (see ReadMethod).
+      ReadMethod readMethod = ReadMethodStream;
+
+      /// Set the number of data packets (up to 64 KiB each) kept in memory by each point data
+      /// reader (see CompressedVectorReader::setPacketCacheSize()). Files with many fields per
+      /// point may be read faster with a larger cache.
+      unsigned packetCacheSize = 32;
+
+      /// Set the number of threads each point data reader uses to decode the fields of the points
+      /// (see CompressedVectorReader::setDecodeThreadCount()). The default of 1 decodes everything
+      /// on the calling thread.
+      unsigned decodeThreadCount = 1;
    };
 
    /// @brief Used for reading an E57 file using E57 Simple API.
@@ -58,6 +73,11 @@ namespace e57
       /// @param [in] options Options to be used for the file
       Reader( const ustring &filePath, const ReaderOptions &options );
 
+      /// @brief Reader constructor
+      /// @param [in] device Device holding the E57 data (see IODevice)
+      /// @param [in] options Options to be used for the file (readMethod is ignored)
+      Reader( std::shared_ptr<IODevice> device, const ReaderOptions &options );
+
       /// @brief Reader constructor (deprecated)
       /// @param [in] filePath Path to E57 file
       /// @deprecated Will be removed in 4.0. Use Reader( const ustring &, const ReaderOptions & )
@@ -70,6 +90,8 @@ namespace e57
       bool IsOpen() const;
 
       /// @brief Closes the file
+      /// @throw ::ErrorBadChecksum if ChecksumBackground found a bad checksum which has not been
+      /// reported yet
       bool Close();
 
       /// @name File information
@@ -181,6 +203,25 @@ namespace e57
       CompressedVectorReader SetUpData3DPointsData( int64_t dataIndex, size_t pointCount,
                                                     const Data3DPointsDouble &buffers ) const;
 
+      /// @brief Reads a range of points into the provided buffers.
+      /// @details All the non-NULL buffers in buffers have at least pointCount elements. The
+      /// points are decoded starting from the closest chunk of the data before startPoint, so
+      /// earlier points aren't read. To read a series of ranges, use SetUpData3DPointsData() and
+      /// CompressedVectorReader::read( uint64_t, size_t ), which carries on from the last range
+      /// without seeking when the ranges follow each other.
+      /// @param [in] dataIndex data block index
+      /// @param [in] startPoint index of the first point to read
+      /// @param [in] pointCount number of points to read
+      /// @param [in] buffers pointers to user-provided buffers
+      /// @return Returns the number of points read, which is less than pointCount if the range
+      /// runs past the last point
+      size_t ReadData3DRange( int64_t dataIndex, int64_t startPoint, size_t pointCount,
+                              const Data3DPointsFloat &buffers ) const;
+
+      /// @overload
+      size_t ReadData3DRange( int64_t dataIndex, int64_t startPoint, size_t pointCount,
+                              const Data3DPointsDouble &buffers ) const;
+
       ///@}
 
       /// @name File information
@@ -61,6 +61,12 @@ namespace e57
       /// @param [in] options Options to be used for the file
       Writer( const ustring &filePath, const WriterOptions &options );
 
+      /// @brief Writer constructor
+      /// @param [in] device Device to write the E57 data to (see IODevice). Anything already in it
+      /// is removed.
+      /// @param [in] options Options to be used for the file
+      Writer( std::shared_ptr<IODevice> device, const WriterOptions &options );
+
       /// @brief Writer constructor (deprecated)
       /// @param [in] filePath Path to E57 file
       /// @param [in] coordinateMetadata Information describing the Coordinate Reference System to
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: BSL-1.0
+// Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+
+#include <cstring>
+
+#include "BitUnpack.h"
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define E57_UNPACK_X86_64
+#endif
+
+#ifdef E57_UNPACK_X86_64
+#include <immintrin.h> // AVX2
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+// GCC & clang need to be told which functions may use these instructions.
+// MSVC allows intrinsics anywhere.
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define E57_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#else
+#define E57_TARGET_AVX2
+#endif
+#endif
+
+namespace
+{
+   using UnpackFunction = void ( * )( const char *source, size_t sourceSize, size_t firstBit,
+                                      unsigned bitsPerValue, size_t count, uint64_t *dest );
+
+   // A value of up to this many bits is always within the 8 bytes starting at the byte holding
+   // its first bit, whatever bit of that byte it starts at.
+   constexpr unsigned cMaxSingleLoadBits = 64 - 7;
+
+   inline uint64_t load64( const char *buf )
+   {
+      uint64_t value;
+      memcpy( &value, buf, sizeof( value ) );
+      return value;
+   }
+
+   inline uint64_t valueMask( unsigned bitsPerValue )
+   {
+      return ( bitsPerValue >= 64 ) ? UINT64_MAX : ( ( uint64_t{ 1 } << bitsPerValue ) - 1 );
+   }
+
+   // Number of values at the start which can each be read with one 8-byte load without reading
+   // past the end of the source.
+   size_t singleLoadCount( size_t sourceSize, size_t firstBit, unsigned bitsPerValue,
+                           size_t count )
+   {
+      if ( bitsPerValue == 0 || bitsPerValue > cMaxSingleLoadBits ||
+           sourceSize < sizeof( uint64_t ) )
+      {
+         return 0;
+      }
+
+      // The load for a value starting at bit p covers bytes p / 8 to p / 8 + 7
+      const size_t cLastStartBit = ( sourceSize - sizeof( uint64_t ) ) * 8 + 7;
+
+      if ( firstBit > cLastStartBit )
+      {
+         return 0;
+      }
+
+      const size_t cLoadable = ( cLastStartBit - firstBit ) / bitsPerValue + 1;
+
+      return ( cLoadable < count ) ? cLoadable : count;
+   }
+
+   // Read values near the end of the source a byte at a time, so we don't read past it.
+   void unpackTail( const char *source, size_t firstBit, unsigned bitsPerValue, size_t count,
+                    uint64_t *dest )
+   {
+      if ( bitsPerValue == 0 )
+      {
+         memset( dest, 0, count * sizeof( uint64_t ) );
+         return;
+      }
+
+      const uint64_t cMask = valueMask( bitsPerValue );
+
+      for ( size_t i = 0; i < count; ++i )
+      {
+         const size_t cBit = firstBit + i * bitsPerValue;
+         const size_t cByte = cBit / 8;
+         const unsigned cShift = cBit % 8;
+
+         // A 64-bit value which doesn't start on a byte boundary touches nine bytes
+         const size_t cBytesNeeded = ( cShift + bitsPerValue + 7 ) / 8;
+
+         uint64_t low = 0;
+         memcpy( &low, source + cByte, ( cBytesNeeded < 8 ) ? cBytesNeeded : 8 );
+
+         uint64_t value = low >> cShift;
+
+         if ( cBytesNeeded > 8 )
+         {
+            value |= static_cast<uint64_t>( static_cast<uint8_t>( source[cByte + 8] ) )
+                     << ( 64 - cShift );
+         }
+
+         dest[i] = value & cMask;
+      }
+   }
+
+#ifdef E57_UNPACK_X86_64
+   // Each 64-bit lane gathers the 8 bytes holding one value, then shifts it down and masks it.
+   // Two gathers per iteration keep the loads for 8 values in flight at once.
+   E57_TARGET_AVX2 void unpackBitsAVX2( const char *source, size_t sourceSize, size_t firstBit,
+                                        unsigned bitsPerValue, size_t count, uint64_t *dest )
+   {
+      const size_t cVectorCount = singleLoadCount( sourceSize, firstBit, bitsPerValue, count );
+
+      size_t i = 0;
+
+      if ( cVectorCount >= 8 )
+      {
+         const auto cBits = static_cast<long long>( bitsPerValue );
+         const auto cFirst = static_cast<long long>( firstBit );
+
+         const __m256i cMask = _mm256_set1_epi64x( static_cast<long long>( valueMask(
+            bitsPerValue ) ) );
+         const __m256i cSeven = _mm256_set1_epi64x( 7 );
+         const __m256i cStep = _mm256_set1_epi64x( 8 * cBits );
+
+         __m256i position0 = _mm256_set_epi64x( cFirst + 3 * cBits, cFirst + 2 * cBits,
+                                                cFirst + cBits, cFirst );
+         __m256i position1 = _mm256_add_epi64( position0, _mm256_set1_epi64x( 4 * cBits ) );
+
+         const auto *base = reinterpret_cast<const long long *>( source );
+
+         for ( ; i + 8 <= cVectorCount; i += 8 )
+         {
+            const __m256i cWords0 =
+               _mm256_i64gather_epi64( base, _mm256_srli_epi64( position0, 3 ), 1 );
+            const __m256i cWords1 =
+               _mm256_i64gather_epi64( base, _mm256_srli_epi64( position1, 3 ), 1 );
+
+            const __m256i cValues0 = _mm256_and_si256(
+               _mm256_srlv_epi64( cWords0, _mm256_and_si256( position0, cSeven ) ), cMask );
+            const __m256i cValues1 = _mm256_and_si256(
+               _mm256_srlv_epi64( cWords1, _mm256_and_si256( position1, cSeven ) ), cMask );
+
+            _mm256_storeu_si256( reinterpret_cast<__m256i *>( dest + i ), cValues0 );
+            _mm256_storeu_si256( reinterpret_cast<__m256i *>( dest + i + 4 ), cValues1 );
+
+            position0 = _mm256_add_epi64( position0, cStep );
+            position1 = _mm256_add_epi64( position1, cStep );
+         }
+      }
+
+      e57::unpackBitsScalar( source, sourceSize, firstBit + i * bitsPerValue, bitsPerValue,
+                             count - i, dest + i );
+   }
+
+   bool hasAVX2()
+   {
+#if defined( _MSC_VER )
+      int info[4];
+
+      __cpuid( info, 0 );
+
+      if ( info[0] < 7 )
+      {
+         return false;
+      }
+
+      __cpuid( info, 1 );
+
+      // The OS must save the YMM registers (OSXSAVE, then XCR0 bits 1 & 2)
+      if ( ( info[2] & ( 1 << 27 ) ) == 0 || ( _xgetbv( 0 ) & 6 ) != 6 )
+      {
+         return false;
+      }
+
+      __cpuidex( info, 7, 0 );
+
+      return ( info[1] & ( 1 << 5 ) ) != 0;
+#else
+      // Also checks that the OS supports the AVX registers
+      return __builtin_cpu_supports( "avx2" ) != 0;
+#endif
+   }
+#endif
+
+   // Pick the fastest implementation this CPU supports.
+   UnpackFunction selectUnpackFunction()
+   {
+#ifdef E57_UNPACK_X86_64
+      if ( hasAVX2() )
+      {
+         return unpackBitsAVX2;
+      }
+#endif
+
+      return e57::unpackBitsScalar;
+   }
+}
+
+namespace e57
+{
+   void unpackBits( const char *source, size_t sourceSize, size_t firstBit, unsigned bitsPerValue,
+                    size_t count, uint64_t *dest )
+   {
+      static const UnpackFunction sUnpackFunction = selectUnpackFunction();
+
+      sUnpackFunction( source, sourceSize, firstBit, bitsPerValue, count, dest );
+   }
+
+   void unpackBitsScalar( const char *source, size_t sourceSize, size_t firstBit,
+                          unsigned bitsPerValue, size_t count, uint64_t *dest )
+   {
+      const size_t cLoadCount = singleLoadCount( sourceSize, firstBit, bitsPerValue, count );
+      const uint64_t cMask = valueMask( bitsPerValue );
+
+      // No branches: one unaligned load, shift, and mask per value
+      size_t bit = firstBit;
+
+      for ( size_t i = 0; i < cLoadCount; ++i )
+      {
+         dest[i] = ( load64( source + bit / 8 ) >> ( bit % 8 ) ) & cMask;
+
+         bit += bitsPerValue;
+      }
+
+      unpackTail( source, bit, bitsPerValue, count - cLoadCount, dest + cLoadCount );
+   }
+}
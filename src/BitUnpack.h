@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: BSL-1.0
+// Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace e57
+{
+   /// @brief Extract values which were packed back to back into a little-endian stream of bits
+   /// @details Value i is the @a bitsPerValue (1-64) bits starting at bit
+   /// ( @a firstBit + i * @a bitsPerValue ) of @a source, where bit 0 is the lowest bit of the
+   /// first byte. All the bits must be within the first @a sourceSize bytes, and nothing after them
+   /// is read.
+   ///
+   /// Uses AVX2 when it is available at runtime and falls back to unpackBitsScalar() otherwise.
+   /// The result is identical either way.
+   void unpackBits( const char *source, size_t sourceSize, size_t firstBit, unsigned bitsPerValue,
+                    size_t count, uint64_t *dest );
+
+   /// @brief Extract packed values one at a time without SIMD instructions
+   void unpackBitsScalar( const char *source, size_t sourceSize, size_t firstBit,
+                          unsigned bitsPerValue, size_t count, uint64_t *dest );
+}
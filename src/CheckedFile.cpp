@@ -46,9 +46,12 @@
 #ifndef __LARGE64_FILES
 #define __LARGE64_FILES
 #endif
+#include <io.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#define NOMINMAX
+#include <windows.h>
 #else
 #error "no supported compiler defined"
 #endif
@@ -59,13 +62,16 @@
 #ifndef __LARGE64_FILES
 #define __LARGE64_FILES
 #endif
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #elif defined( __APPLE__ )
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <unistd.h>
 #elif defined( __BSD )
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -73,14 +79,15 @@
 #error "no supported OS platform defined"
 #endif
 
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <fcntl.h>
 
-#include "CRC.h"
-
 #include "CheckedFile.h"
+#include "Checksum.h"
+#include "IoUring.h"
 #include "StringFunctions.h"
 
 // Fallback
@@ -101,9 +108,35 @@ constexpr size_t CheckedFile::physicalPageSizeLog2;
 constexpr size_t CheckedFile::physicalPageSize;
 constexpr uint64_t CheckedFile::physicalPageSizeMask;
 constexpr size_t CheckedFile::logicalPageSize;
+constexpr size_t CheckedFile::maxReadPages;
+constexpr size_t CheckedFile::maxWritePages;
 
 namespace
 {
+   // ChecksumBackground: readAt() waits if more than this many pages are waiting to be verified
+   constexpr size_t cMaxVerifyQueuePages = 16 * CheckedFile::maxReadPages;
+
+   // prefetch() keeps up to this many chunks of this many pages
+   constexpr size_t cPrefetchChunks = 8;
+   constexpr size_t cPrefetchChunkPages = 64;
+
+#ifdef E57_IO_URING
+   // With io_uring, each read keeps this many chunks (starting with its last page) in flight
+   constexpr size_t cReadAheadChunks = 4;
+
+   // io_uring userData for the write-behind request (prefetch chunks use their index)
+   constexpr uint64_t cWriteBehindUserData = 1000;
+#endif
+
+   using Clock = std::chrono::steady_clock;
+
+   /// Nanoseconds elapsed since start
+   uint64_t nanosecondsSince( Clock::time_point start )
+   {
+      return static_cast<uint64_t>(
+         std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - start ).count() );
+   }
+
    inline uint32_t swap_uint32( uint32_t val )
    {
       val = ( ( val << 8 ) & 0xFF00FF00 ) | ( ( val >> 8 ) & 0xFF00FF );
@@ -112,14 +145,9 @@ namespace
    }
 
    /// Calc CRC32C of given data
-   uint32_t checksum( char *buf, size_t size )
+   uint32_t checksum( const char *buf, size_t size )
    {
-      static const CRC::Parameters<crcpp_uint32, 32> sCRCParams{ 0x1EDC6F41, 0xFFFFFFFF, 0xFFFFFFFF,
-                                                                 true, true };
-
-      static const CRC::Table<crcpp_uint32, 32> sCRCTable = sCRCParams.MakeTable();
-
-      auto crc = CRC::Calculate<crcpp_uint32, 32>( buf, size, sCRCTable );
+      auto crc = crc32c( buf, size );
 
       // (Andy) I don't understand why we need to swap bytes here
       crc = swap_uint32( crc );
@@ -140,58 +168,28 @@ public:
    {
    }
 
-   uint64_t pos() const
-   {
-      return cursorStream_;
-   }
-
-   bool seek( uint64_t offset, int whence )
+   void read( uint64_t offset, char *buffer, uint64_t count ) const
    {
-      if ( whence == SEEK_CUR )
-      {
-         cursorStream_ += offset;
-      }
-      else if ( whence == SEEK_SET )
-      {
-         cursorStream_ = offset;
-      }
-      else if ( whence == SEEK_END )
-      {
-         cursorStream_ = streamSize_ - offset;
-      }
-
-      if ( cursorStream_ > streamSize_ )
-      {
-         cursorStream_ = streamSize_;
-         return false;
-      }
-
-      return true;
+      memcpy( buffer, data( offset, count ), static_cast<size_t>( count ) );
    }
 
-   void read( char *buffer, uint64_t count )
+   /// Returns a pointer to count bytes at offset without copying them.
+   const char *data( uint64_t offset, uint64_t count ) const
    {
-      const uint64_t start = cursorStream_;
-
-      // Written as ( count > streamSize_ - start ) rather than ( start + count > streamSize_ )
+      // Written as ( count > streamSize_ - offset ) rather than ( offset + count > streamSize_ )
       // so the check itself cannot overflow.
-      if ( start > streamSize_ || count > streamSize_ - start )
+      if ( offset > streamSize_ || count > streamSize_ - offset )
       {
-         throw E57_EXCEPTION2( ErrorReadFailed, "pos=" + toString( start ) +
+         throw E57_EXCEPTION2( ErrorReadFailed, "pos=" + toString( offset ) +
                                                    " count=" + toString( count ) +
                                                    " bufferSize=" + toString( streamSize_ ) );
       }
 
-      for ( uint64_t i = 0; i < count; ++i )
-      {
-         buffer[i] = stream_[start + i];
-         ++cursorStream_;
-      }
+      return stream_ + offset;
    }
 
 private:
    const uint64_t streamSize_;
-   uint64_t cursorStream_ = 0;
    const char *stream_;
 };
 
@@ -201,6 +199,7 @@ CheckedFile::CheckedFile( const ustring &fileName, Mode mode, ReadChecksumPolicy
    switch ( mode )
    {
       case Read:
+      case ReadMemoryMap:
       {
          constexpr int readFlags = O_RDONLY | O_BINARY;
 
@@ -216,9 +215,26 @@ CheckedFile::CheckedFile( const ustring &fileName, Mode mode, ReadChecksumPolicy
                                   "file length is " + toString( physicalLength_ ) + " bytes" );
          }
 
-         lseek64( 0, SEEK_SET );
-
          logicalLength_ = physicalToLogical( physicalLength_ );
+
+         verifiedPages_.resize( static_cast<size_t>( physicalLength_ / physicalPageSize ), false );
+
+         if ( mode == ReadMemoryMap )
+         {
+            mapFile();
+         }
+
+         if ( checkSumPolicy_ == ChecksumPolicy::ChecksumBackground )
+         {
+            startBackgroundVerify();
+         }
+
+#ifdef E57_IO_URING
+         if ( bufView_ == nullptr )
+         {
+            startIoUring();
+         }
+#endif
       }
       break;
 
@@ -234,11 +250,55 @@ CheckedFile::CheckedFile( const ustring &fileName, Mode mode, ReadChecksumPolicy
 #endif
 
          fd_ = open64( fileName_, writeFlags, writeMode );
+
+         writeBuffer_.resize( maxWritePages * physicalPageSize );
+
+#ifdef E57_IO_URING
+         startIoUring();
+#endif
       }
       break;
    }
 }
 
+CheckedFile::CheckedFile( std::shared_ptr<IODevice> device, Mode mode, ReadChecksumPolicy policy ) :
+   fileName_( "<IODevice>" ), checkSumPolicy_( policy ), device_( std::move( device ) )
+{
+   if ( mode == Write )
+   {
+      // Like a file opened for writing, start with nothing
+      if ( ( device_->size() != 0 ) && !device_->resize( 0 ) )
+      {
+         throw E57_EXCEPTION2( ErrorOpenFailed,
+                               "fileName=" + fileName_ + " size=" + toString( device_->size() ) );
+      }
+
+      writeBuffer_.resize( maxWritePages * physicalPageSize );
+      return;
+   }
+
+   // ReadMemoryMap is treated as Read: we don't know where the device's data comes from
+
+   readOnly_ = true;
+
+   physicalLength_ = device_->size();
+
+   if ( physicalLength_ % 1024 != 0 )
+   {
+      throw E57_EXCEPTION2( ErrorBadInputDataSize,
+                            "device length is " + toString( physicalLength_ ) + " bytes" );
+   }
+
+   logicalLength_ = physicalToLogical( physicalLength_ );
+
+   verifiedPages_.resize( static_cast<size_t>( physicalLength_ / physicalPageSize ), false );
+
+   if ( checkSumPolicy_ == ChecksumPolicy::ChecksumBackground )
+   {
+      startBackgroundVerify();
+   }
+}
+
 CheckedFile::CheckedFile( const char *input, uint64_t size, ReadChecksumPolicy policy ) :
    fileName_( "<StreamBuffer>" ), checkSumPolicy_( policy )
 {
@@ -252,10 +312,184 @@ CheckedFile::CheckedFile( const char *input, uint64_t size, ReadChecksumPolicy p
 
    readOnly_ = true;
 
-   physicalLength_ = lseek64( 0LL, SEEK_END );
-   lseek64( 0, SEEK_SET );
+   physicalLength_ = size;
 
    logicalLength_ = physicalToLogical( physicalLength_ );
+
+   verifiedPages_.resize( static_cast<size_t>( physicalLength_ / physicalPageSize ), false );
+
+   if ( checkSumPolicy_ == ChecksumPolicy::ChecksumBackground )
+   {
+      startBackgroundVerify();
+   }
+}
+
+void CheckedFile::mapFile()
+{
+   // If the file can't be mapped, leave things as they are and fall back to reading using fd_.
+
+   // Can't map an empty file
+   if ( physicalLength_ == 0 )
+   {
+      return;
+   }
+
+#ifdef E57_32_BIT
+   // ... or one which doesn't fit in our address space
+   if ( physicalLength_ > SIZE_MAX )
+   {
+      return;
+   }
+#endif
+
+   const auto cMapSize = static_cast<size_t>( physicalLength_ );
+
+#if defined( _WIN32 )
+   HANDLE fileHandle = reinterpret_cast<HANDLE>( ::_get_osfhandle( fd_ ) );
+
+   if ( fileHandle == INVALID_HANDLE_VALUE )
+   {
+      return;
+   }
+
+   HANDLE mappingHandle = ::CreateFileMappingW( fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+   if ( mappingHandle == nullptr )
+   {
+      return;
+   }
+
+   void *mapping = ::MapViewOfFile( mappingHandle, FILE_MAP_READ, 0, 0, cMapSize );
+
+   // The view keeps its own reference to the mapping object
+   ::CloseHandle( mappingHandle );
+
+   if ( mapping == nullptr )
+   {
+      return;
+   }
+#else
+   void *mapping = ::mmap( nullptr, cMapSize, PROT_READ, MAP_PRIVATE, fd_, 0 );
+
+   if ( mapping == MAP_FAILED )
+   {
+      return;
+   }
+#endif
+
+   mapping_ = mapping;
+
+   // Serve all reads from the mapping using the same code we use for user buffers
+   bufView_ = new BufferView( static_cast<const char *>( mapping_ ), physicalLength_ );
+
+   // The mapping stays valid after the file is closed, so we don't need fd_ anymore
+#if defined( _MSC_VER )
+   ::_close( fd_ );
+#else
+   ::close( fd_ );
+#endif
+
+   fd_ = -1;
+}
+
+void CheckedFile::unmapFile()
+{
+   if ( mapping_ == nullptr )
+   {
+      return;
+   }
+
+#if defined( _WIN32 )
+   const bool failed = ( ::UnmapViewOfFile( mapping_ ) == 0 );
+#else
+   const bool failed = ( ::munmap( mapping_, static_cast<size_t>( physicalLength_ ) ) != 0 );
+#endif
+
+   mapping_ = nullptr;
+
+   if ( failed )
+   {
+      throw E57_EXCEPTION2( ErrorCloseFailed, "fileName=" + fileName_ + " (unmap failed)" );
+   }
+}
+
+void CheckedFile::adviseAccess( uint64_t logicalOffset, uint64_t logicalLength,
+                                AccessPattern pattern )
+{
+   // These are only hints, so ignore any failures.
+   // Nothing to do for in-memory buffers or devices (or files we are writing).
+   if ( !readOnly_ || ( logicalLength == 0 ) || ( ( fd_ < 0 ) && ( mapping_ == nullptr ) ) )
+   {
+      return;
+   }
+
+   const uint64_t cStart = std::min( logicalToPhysical( logicalOffset ), physicalLength_ );
+   const uint64_t cEnd =
+      std::min( logicalToPhysical( logicalOffset + logicalLength ), physicalLength_ );
+
+   if ( cStart >= cEnd )
+   {
+      return;
+   }
+
+#if defined( _WIN32 )
+   E57_UNUSED( pattern );
+#else
+   if ( mapping_ != nullptr )
+   {
+      // madvise() needs an address aligned to the OS page size
+      static const auto sPageSize = static_cast<uint64_t>( ::sysconf( _SC_PAGESIZE ) );
+
+      const uint64_t cAlignedStart = cStart - ( cStart % sPageSize );
+
+      int advice = MADV_NORMAL;
+
+      switch ( pattern )
+      {
+         case AccessNormal:
+            break;
+         case AccessSequential:
+            advice = MADV_SEQUENTIAL;
+            break;
+         case AccessWillNeed:
+            advice = MADV_WILLNEED;
+            break;
+         case AccessDontNeed:
+            // The mapping is private & read-only, so the pages are just read again if needed
+            advice = MADV_DONTNEED;
+            break;
+      }
+
+      ::madvise( static_cast<char *>( mapping_ ) + cAlignedStart,
+                 static_cast<size_t>( cEnd - cAlignedStart ), advice );
+      return;
+   }
+
+#if defined( __linux__ )
+   int advice = POSIX_FADV_NORMAL;
+
+   switch ( pattern )
+   {
+      case AccessNormal:
+         break;
+      case AccessSequential:
+         advice = POSIX_FADV_SEQUENTIAL;
+         break;
+      case AccessWillNeed:
+         advice = POSIX_FADV_WILLNEED;
+         break;
+      case AccessDontNeed:
+         advice = POSIX_FADV_DONTNEED;
+         break;
+   }
+
+   ::posix_fadvise64( fd_, static_cast<off64_t>( cStart ), static_cast<off64_t>( cEnd - cStart ),
+                      advice );
+#else
+   // macOS & BSD don't have (a useful) posix_fadvise()
+   E57_UNUSED( pattern );
+#endif
+#endif
 }
 
 int CheckedFile::open64( const ustring &fileName, int flags, int mode )
@@ -331,11 +565,24 @@ CheckedFile::~CheckedFile()
 
 void CheckedFile::read( char *buf, size_t nRead, size_t /*bufSize*/ )
 {
+   //??? check bufSize OK
+
+   const uint64_t logicalOffset = position( Logical );
+
+   readAt( logicalOffset, buf, nRead );
+
+   // When done, leave cursor just past end of last byte read
+   seek( logicalOffset + nRead, Logical );
+}
+
+void CheckedFile::readAt( uint64_t logicalOffset, char *buf, size_t nRead )
+{
+   std::lock_guard<std::mutex> readLock( readMutex_ );
+
    //??? what if read past logical end?, or physical end?
    //??? need to keep track of logical length?
-   //??? check bufSize OK
 
-   const uint64_t end = position( Logical ) + nRead;
+   const uint64_t end = logicalOffset + nRead;
    const uint64_t logicalLength = length( Logical );
 
    if ( end > logicalLength )
@@ -344,122 +591,343 @@ void CheckedFile::read( char *buf, size_t nRead, size_t /*bufSize*/ )
                                               " length=" + toString( logicalLength ) );
    }
 
+   // Report any failure found in pages we've already returned
+   if ( checkSumPolicy_ == ChecksumPolicy::ChecksumBackground )
+   {
+      checkBackgroundVerifyError();
+   }
+
+   // If we are reading a file we are writing, make sure the disk is up to date
+   if ( writeBufferDirty_ )
+   {
+      flushWriteBuffer();
+   }
+
    uint64_t page = 0;
    size_t pageOffset = 0;
 
-   getCurrentPageAndOffset( page, pageOffset );
+   getPageAndOffset( logicalOffset, page, pageOffset );
 
    size_t n = std::min( nRead, logicalPageSize - pageOffset );
 
-   // Allocate temp page buffer
-   std::vector<char> page_buffer_v( physicalPageSize );
-   char *page_buffer = page_buffer_v.data();
+   // ChecksumBackground: pages which need verifying
+   VerifyJob verifyJob;
+
+   // Work on runs of consecutive physical pages: read each run with one call instead of one call
+   // per page, then check the CRCs and strip the checksums out in memory.
+   // If the whole file is in memory (the caller's buffer or our mapping), check the pages where
+   // they are and copy the logical bytes straight to buf. Otherwise read them into a temp buffer.
+   const size_t pagesNeeded = ( pageOffset + nRead + logicalPageSize - 1 ) / logicalPageSize;
+   const size_t maxRunPages = std::min( pagesNeeded, maxReadPages );
+
+   std::vector<char> page_buffer_v;
+
+   if ( bufView_ == nullptr )
+   {
+      page_buffer_v.resize( maxRunPages * physicalPageSize );
+   }
 
    while ( nRead > 0 )
    {
-      readPhysicalPage( page_buffer, page );
+      // Number of pages left to read, limited by the size of our temp buffer
+      const size_t pagesLeft = ( pageOffset + nRead + logicalPageSize - 1 ) / logicalPageSize;
+      const size_t runPages = std::min( pagesLeft, maxRunPages );
 
-      switch ( checkSumPolicy_ )
-      {
-         case ChecksumPolicy::ChecksumNone:
-            break;
+      const char *run_buffer = nullptr;
 
-         case ChecksumPolicy::ChecksumAll:
-            verifyChecksum( page_buffer, page );
-            break;
+      if ( bufView_ != nullptr )
+      {
+         run_buffer = bufView_->data( page * physicalPageSize, runPages * physicalPageSize );
 
-         default:
-         {
-            const auto checksumMod =
-               static_cast<unsigned int>( std::nearbyint( 100.0 / checkSumPolicy_ ) );
+         stats_.pagesRead += runPages;
+      }
+      else
+      {
+         readPhysicalPages( page_buffer_v.data(), page, runPages );
 
-            if ( !( page % checksumMod ) || ( nRead < physicalPageSize ) )
-            {
-               verifyChecksum( page_buffer, page );
-            }
-         }
-         break;
+         run_buffer = page_buffer_v.data();
       }
 
-      memcpy( buf, page_buffer + pageOffset, n );
+      checkPages( run_buffer, page, runPages, pageOffset, nRead, verifyJob );
 
-      buf += n;
-      nRead -= n;
-      pageOffset = 0;
-      ++page;
+      for ( size_t i = 0; i < runPages; ++i )
+      {
+         memcpy( buf, run_buffer + i * physicalPageSize + pageOffset, n );
 
-      n = std::min( nRead, logicalPageSize );
-   }
+         stats_.bytesCopied += n;
 
-   // When done, leave cursor just past end of last byte read
-   seek( end, Logical );
+         buf += n;
+         nRead -= n;
+         pageOffset = 0;
+
+         n = std::min( nRead, logicalPageSize );
+      }
+
+      page += runPages;
+
+      queueBackgroundVerify( verifyJob );
+   }
 }
 
-void CheckedFile::write( const char *buf, size_t nWrite )
+const char *CheckedFile::readInPlace( uint64_t logicalOffset, size_t nRead )
 {
-#ifdef E57_VERBOSE
-   // cout << "write nWrite=" << nWrite << " position()="<< position() << std::endl;
-   // //???
-#endif
-   if ( readOnly_ )
+   // Only possible if the file is in memory
+   if ( bufView_ == nullptr )
    {
-      throw E57_EXCEPTION2( ErrorFileReadOnly, "fileName=" + fileName_ );
+      return nullptr;
    }
 
-   uint64_t end = position( Logical ) + nWrite;
+   const uint64_t end = logicalOffset + nRead;
+   const uint64_t logicalLength = length( Logical );
+
+   if ( end > logicalLength )
+   {
+      throw E57_EXCEPTION2( ErrorInternal, "fileName=" + fileName_ + " end=" + toString( end ) +
+                                              " length=" + toString( logicalLength ) );
+   }
 
    uint64_t page = 0;
    size_t pageOffset = 0;
 
-   getCurrentPageAndOffset( page, pageOffset );
+   getPageAndOffset( logicalOffset, page, pageOffset );
 
-   size_t n = std::min( nWrite, logicalPageSize - pageOffset );
+   // The bytes must be contiguous, so they can't cross into the next page's checksum
+   if ( pageOffset + nRead > logicalPageSize )
+   {
+      return nullptr;
+   }
 
-   // Allocate temp page buffer
-   std::vector<char> page_buffer_v( physicalPageSize );
-   char *page_buffer = page_buffer_v.data();
+   std::lock_guard<std::mutex> readLock( readMutex_ );
 
-   while ( nWrite > 0 )
+   if ( checkSumPolicy_ == ChecksumPolicy::ChecksumBackground )
    {
-      const uint64_t physicalLength = length( Physical );
+      checkBackgroundVerifyError();
+   }
 
-      if ( page * physicalPageSize < physicalLength )
-      {
-         readPhysicalPage( page_buffer, page );
-      }
+   const char *page_buffer = bufView_->data( page * physicalPageSize, physicalPageSize );
 
-#ifdef E57_VERBOSE
-      // cout << "  page_buffer[0] read: '" << page_buffer[0] << "'" << std::endl;
-      // cout << "copy " << n << "bytes to page=" << page << " pageOffset=" <<
-      // pageOffset << " buf='"; //??? for (size_t i=0; i < n; i++) cout <<
-      // buf[i]; cout << "'" << std::endl;
-#endif
-      memcpy( page_buffer + pageOffset, buf, n );
-      writePhysicalPage( page_buffer, page );
-#ifdef E57_VERBOSE
-      // cout << "  page_buffer[0] after write: '" << page_buffer[0] << "'" <<
-      // std::endl; //???
-#endif
-      buf += n;
-      nWrite -= n;
-      pageOffset = 0;
-      page++;
-      n = std::min( nWrite, logicalPageSize );
-   }
+   ++stats_.pagesRead;
 
-   if ( end > logicalLength_ )
-   {
-      logicalLength_ = end;
-   }
+   VerifyJob verifyJob;
 
-   // When done, leave cursor just past end of buf
-   seek( end, Logical );
+   checkPages( page_buffer, page, 1, pageOffset, nRead, verifyJob );
+
+   queueBackgroundVerify( verifyJob );
+
+   return page_buffer + pageOffset;
 }
 
-CheckedFile &CheckedFile::operator<<( const ustring &s )
+void CheckedFile::checkPages( const char *page_buffer, uint64_t page, size_t pageCount,
+                              size_t pageOffset, size_t nRead, VerifyJob &verifyJob )
 {
-   write( s.c_str(), s.length() ); //??? should be times size of uchar?
-   return ( *this );
+   // Only start the clock once we verify something so pages already verified stay cheap to read
+   Clock::time_point start;
+   uint64_t pagesVerified = 0;
+
+   for ( size_t i = 0; i < pageCount; ++i, ++page )
+   {
+      const char *pageStart = page_buffer + i * physicalPageSize;
+
+      // Pages reserved by extend() but not written yet have no checksum on disk, and pages we
+      // have already verified don't need to be checked again
+      const bool cSkipChecksum = isZeroPage( page ) || isVerifiedPage( page );
+      const ReadChecksumPolicy cPolicy =
+         cSkipChecksum ? ChecksumPolicy::ChecksumNone : checkSumPolicy_;
+
+      bool verify = false;
+
+      switch ( cPolicy )
+      {
+         case ChecksumPolicy::ChecksumNone:
+            break;
+
+         case ChecksumPolicy::ChecksumAll:
+            verify = true;
+            break;
+
+         case ChecksumPolicy::ChecksumBackground:
+            verifyJob.pages.push_back( page );
+
+            // Our temp buffer is reused, so the background thread needs its own copy.
+            // (Pages in bufView_ are checked where they are.)
+            if ( bufView_ == nullptr )
+            {
+               verifyJob.buffer.insert( verifyJob.buffer.end(), pageStart,
+                                        pageStart + physicalPageSize );
+            }
+
+            // Any failure will be reported later, so don't queue it again
+            markVerifiedPage( page );
+            break;
+
+         default:
+         {
+            const auto checksumMod = static_cast<unsigned int>( std::nearbyint( 100.0 / cPolicy ) );
+
+            verify = !( page % checksumMod ) || ( nRead < physicalPageSize );
+         }
+         break;
+      }
+
+      if ( verify )
+      {
+         if ( pagesVerified++ == 0 )
+         {
+            start = Clock::now();
+         }
+
+         verifyChecksum( pageStart, page );
+      }
+      else if ( cPolicy != ChecksumPolicy::ChecksumBackground )
+      {
+         ++stats_.pagesNotVerified;
+      }
+
+      // Number of bytes left to read after this page
+      nRead -= std::min( nRead, logicalPageSize - pageOffset );
+      pageOffset = 0;
+   }
+
+   if ( pagesVerified > 0 )
+   {
+      stats_.pagesVerified += pagesVerified;
+      stats_.checksumNanoseconds += nanosecondsSince( start );
+   }
+}
+
+void CheckedFile::queueBackgroundVerify( VerifyJob &verifyJob )
+{
+   if ( verifyJob.pages.empty() )
+   {
+      return;
+   }
+
+   std::unique_lock<std::mutex> lock( verifyMutex_ );
+
+   // Don't let the queue grow without limit if we are reading faster than we can verify
+   verifyCondition_.wait( lock, [this] {
+      return ( verifyQueuePages_ < cMaxVerifyQueuePages ) || ( verifyError_ != nullptr );
+   } );
+
+   verifyQueuePages_ += verifyJob.pages.size();
+   verifyQueue_.push_back( std::move( verifyJob ) );
+
+   verifyCondition_.notify_all();
+
+   verifyJob = VerifyJob();
+}
+
+void CheckedFile::write( const char *buf, size_t nWrite )
+{
+#ifdef E57_VERBOSE
+   // cout << "write nWrite=" << nWrite << " position()="<< position() << std::endl;
+   // //???
+#endif
+   const uint64_t logicalOffset = position( Logical );
+
+   writeAt( logicalOffset, buf, nWrite );
+
+   // When done, leave cursor just past end of buf
+   seek( logicalOffset + nWrite, Logical );
+}
+
+void CheckedFile::writeAt( uint64_t logicalOffset, const char *buf, size_t nWrite )
+{
+   if ( readOnly_ )
+   {
+      throw E57_EXCEPTION2( ErrorFileReadOnly, "fileName=" + fileName_ );
+   }
+
+   const uint64_t end = logicalOffset + nWrite;
+
+   //??? what if loop below throws, logicalLength_ may be wrong
+   if ( end > logicalLength_ )
+   {
+      logicalLength_ = end;
+   }
+
+   uint64_t page = 0;
+   size_t pageOffset = 0;
+
+   getPageAndOffset( logicalOffset, page, pageOffset );
+
+   size_t n = std::min( nWrite, logicalPageSize - pageOffset );
+
+   // Temp buffer, only needed if we modify pages before the write buffer
+   std::vector<char> page_buffer_v;
+
+   while ( nWrite > 0 )
+   {
+#ifdef E57_VERBOSE
+      // cout << "copy " << n << "bytes to page=" << page << " pageOffset=" <<
+      // pageOffset << " buf='"; //??? for (size_t i=0; i < n; i++) cout <<
+      // buf[i]; cout << "'" << std::endl;
+#endif
+      if ( page >= writeBufferPage_ )
+      {
+         memcpy( bufferedPage( page ) + pageOffset, buf, n );
+         writeBufferDirty_ = true;
+
+         stats_.bytesCopied += n;
+
+         buf += n;
+         nWrite -= n;
+         pageOffset = 0;
+         page++;
+         n = std::min( nWrite, logicalPageSize );
+         continue;
+      }
+
+      // Pages before the write buffer are either on disk (e.g. rewriting a header) or reserved
+      // by extend() (e.g. filling in a blob). Update a run of them with a single write.
+      const uint64_t cPagesLeft = ( pageOffset + nWrite + logicalPageSize - 1 ) / logicalPageSize;
+      const auto cRunPages = static_cast<size_t>(
+         std::min<uint64_t>( { cPagesLeft, writeBufferPage_ - page, maxWritePages } ) );
+
+      page_buffer_v.resize( cRunPages * physicalPageSize );
+
+      for ( size_t i = 0; i < cRunPages; ++i )
+      {
+         char *page_buffer = &page_buffer_v[i * physicalPageSize];
+
+         if ( isZeroPage( page + i ) )
+         {
+            memset( page_buffer, 0, logicalPageSize );
+         }
+         else if ( n < logicalPageSize )
+         {
+            // Only part of the page is changing, so we need the rest of it
+            readPhysicalPage( page_buffer, page + i );
+         }
+
+         memcpy( page_buffer + pageOffset, buf, n );
+
+         stats_.bytesCopied += n;
+
+         buf += n;
+         nWrite -= n;
+         pageOffset = 0;
+         n = std::min( nWrite, logicalPageSize );
+      }
+
+      writePhysicalPages( page_buffer_v.data(), page, cRunPages );
+
+      for ( size_t i = 0; i < cRunPages; ++i )
+      {
+         if ( isZeroPage( page + i ) )
+         {
+            zeroPages_[static_cast<size_t>( page + i - zeroPagesStart_ )] = false;
+         }
+      }
+
+      page += cRunPages;
+   }
+}
+
+CheckedFile &CheckedFile::operator<<( const ustring &s )
+{
+   write( s.c_str(), s.length() ); //??? should be times size of uchar?
+   return ( *this );
 }
 
 CheckedFile &CheckedFile::operator<<( int64_t i )
@@ -503,32 +971,26 @@ template <class FTYPE> CheckedFile &CheckedFile::writeFloatingPoint( FTYPE value
 void CheckedFile::seek( uint64_t offset, OffsetMode omode )
 {
    //??? check for seek beyond logicalLength_
-   const auto pos =
-      static_cast<int64_t>( omode == Physical ? offset : logicalToPhysical( offset ) );
+   const uint64_t pos = ( omode == Physical ) ? offset : logicalToPhysical( offset );
 
 #ifdef E57_VERBOSE
    // cout << "seek offset=" << offset << " omode=" << omode << " pos=" << pos
    // << std::endl; //???
 #endif
-   lseek64( pos, SEEK_SET );
-}
 
-uint64_t CheckedFile::lseek64( int64_t offset, int whence )
-{
-   if ( ( fd_ < 0 ) && ( bufView_ != nullptr ) )
+   // Reading files can't go past the end
+   if ( readOnly_ && ( pos > physicalLength_ ) )
    {
-      const auto uoffset = static_cast<uint64_t>( offset );
-
-      if ( bufView_->seek( uoffset, whence ) )
-      {
-         return bufView_->pos();
-      }
-
       throw E57_EXCEPTION2( ErrorSeekFailed, "fileName=" + fileName_ +
                                                 " offset=" + toString( offset ) +
-                                                " whence=" + toString( whence ) );
+                                                " length=" + toString( physicalLength_ ) );
    }
 
+   position_ = pos;
+}
+
+uint64_t CheckedFile::lseek64( int64_t offset, int whence )
+{
 #if defined( _WIN32 )
    __int64 result = _lseeki64( fd_, offset, whence );
 #elif defined( __linux__ ) || defined( __EMSCRIPTEN__ )
@@ -549,38 +1011,139 @@ uint64_t CheckedFile::lseek64( int64_t offset, int whence )
    return static_cast<uint64_t>( result );
 }
 
-uint64_t CheckedFile::position( OffsetMode omode )
+int64_t CheckedFile::pread64( char *buf, size_t count, uint64_t physicalOffset )
 {
-   // Get current file cursor position
-   const uint64_t pos = lseek64( 0LL, SEEK_CUR );
+   if ( device_ )
+   {
+      // prefetchThread_ may be reading too
+      std::lock_guard<std::mutex> lock( deviceMutex_ );
 
-   if ( omode == Physical )
+      return device_->readAt( physicalOffset, buf, count );
+   }
+
+#if defined( _WIN32 )
+   // Windows doesn't have pread, but ReadFile takes an offset in the OVERLAPPED struct
+   HANDLE fileHandle = reinterpret_cast<HANDLE>( ::_get_osfhandle( fd_ ) );
+
+   OVERLAPPED overlapped = {};
+   overlapped.Offset = static_cast<DWORD>( physicalOffset & 0xFFFFFFFF );
+   overlapped.OffsetHigh = static_cast<DWORD>( physicalOffset >> 32 );
+
+   // Limit a single call to 1 GiB so the count fits in a DWORD
+   const auto cCount = static_cast<DWORD>( std::min<size_t>( count, 1 << 30 ) );
+   DWORD bytesRead = 0;
+
+   if ( ::ReadFile( fileHandle, buf, cCount, &bytesRead, &overlapped ) == 0 )
    {
-      return pos;
+      return -1;
    }
 
-   return physicalToLogical( pos );
+   return static_cast<int64_t>( bytesRead );
+#elif defined( __linux__ ) || defined( __EMSCRIPTEN__ )
+   return ::pread64( fd_, buf, count, static_cast<off64_t>( physicalOffset ) );
+#elif defined( __APPLE__ ) || defined( __BSD )
+   return ::pread( fd_, buf, count, static_cast<off_t>( physicalOffset ) );
+#else
+#error "no supported OS platform defined"
+#endif
 }
 
-uint64_t CheckedFile::length( OffsetMode omode )
+int64_t CheckedFile::pwrite64( const char *buf, size_t count, uint64_t physicalOffset )
 {
-   if ( omode == Physical )
+   if ( device_ )
+   {
+      return device_->writeAt( physicalOffset, buf, count );
+   }
+
+#if defined( _WIN32 )
+   // Windows doesn't have pwrite, but WriteFile takes an offset in the OVERLAPPED struct
+   HANDLE fileHandle = reinterpret_cast<HANDLE>( ::_get_osfhandle( fd_ ) );
+
+   OVERLAPPED overlapped = {};
+   overlapped.Offset = static_cast<DWORD>( physicalOffset & 0xFFFFFFFF );
+   overlapped.OffsetHigh = static_cast<DWORD>( physicalOffset >> 32 );
+
+   // Limit a single call to 1 GiB so the count fits in a DWORD
+   const auto cCount = static_cast<DWORD>( std::min<size_t>( count, 1 << 30 ) );
+   DWORD bytesWritten = 0;
+
+   if ( ::WriteFile( fileHandle, buf, cCount, &bytesWritten, &overlapped ) == 0 )
+   {
+      return -1;
+   }
+
+   return static_cast<int64_t>( bytesWritten );
+#elif defined( __linux__ ) || defined( __EMSCRIPTEN__ )
+   return ::pwrite64( fd_, buf, count, static_cast<off64_t>( physicalOffset ) );
+#elif defined( __APPLE__ ) || defined( __BSD )
+   return ::pwrite( fd_, buf, count, static_cast<off_t>( physicalOffset ) );
+#else
+#error "no supported OS platform defined"
+#endif
+}
+
+void CheckedFile::ftruncate64( uint64_t physicalLength )
+{
+#ifdef E57_IO_URING
+   waitForWriteBehind();
+#endif
+
+   ++stats_.writeCalls;
+
+   const Clock::time_point cStart = Clock::now();
+
+   if ( device_ )
    {
-      if ( readOnly_ )
+      const bool cResized = device_->resize( physicalLength );
+
+      stats_.ioNanoseconds += nanosecondsSince( cStart );
+
+      if ( !cResized )
       {
-         return physicalLength_;
+         throw E57_EXCEPTION2( ErrorWriteFailed, "fileName=" + fileName_ +
+                                                    " length=" + toString( physicalLength ) );
       }
 
-      // Current file position
-      uint64_t original_pos = lseek64( 0LL, SEEK_CUR );
+      return;
+   }
+
+#if defined( _WIN32 )
+   // Note that Windows fills the new space with zeros rather than leaving a hole
+   const int result = ::_chsize_s( fd_, static_cast<__int64>( physicalLength ) );
+#elif defined( __linux__ ) || defined( __EMSCRIPTEN__ )
+   const int result = ::ftruncate64( fd_, static_cast<off64_t>( physicalLength ) );
+#elif defined( __APPLE__ ) || defined( __BSD )
+   const int result = ::ftruncate( fd_, static_cast<off_t>( physicalLength ) );
+#else
+#error "no supported OS platform defined"
+#endif
+
+   stats_.ioNanoseconds += nanosecondsSince( cStart );
+
+   if ( result != 0 )
+   {
+      throw E57_EXCEPTION2( ErrorWriteFailed, "fileName=" + fileName_ + " length=" +
+                                                 toString( physicalLength ) +
+                                                 " result=" + toString( result ) );
+   }
+}
 
-      // End file position
-      uint64_t end_pos = lseek64( 0LL, SEEK_END );
+uint64_t CheckedFile::position( OffsetMode omode ) const
+{
+   if ( omode == Physical )
+   {
+      return position_;
+   }
 
-      // Restore original position
-      lseek64( original_pos, SEEK_SET );
+   return physicalToLogical( position_ );
+}
 
-      return end_pos;
+uint64_t CheckedFile::length( OffsetMode omode ) const
+{
+   if ( omode == Physical )
+   {
+      // We track the length ourselves when writing, so no need to ask the OS
+      return physicalLength_;
    }
 
    return logicalLength_;
@@ -620,74 +1183,89 @@ void CheckedFile::extend( uint64_t newLength, OffsetMode omode )
 
    // Calc how may zero bytes we have to add to end
    uint64_t nWrite = newLogicalLength - currentLogicalLength;
+   uint64_t offset = currentLogicalLength;
 
-   // Seek to current end of file
-   seek( currentLogicalLength, Logical );
-
-   uint64_t page = 0;
-   size_t pageOffset = 0;
+   const std::vector<char> zeros( logicalPageSize, 0 );
 
-   getCurrentPageAndOffset( page, pageOffset );
+   // Fill the rest of the current last page with zeros
+   const uint64_t cHeadRoom = ( logicalPageSize - offset % logicalPageSize ) % logicalPageSize;
+   const auto cHeadSize = static_cast<size_t>( std::min( nWrite, cHeadRoom ) );
 
-   // Calc first write size (may be partial page)
-   // Watch out for different int sizes here.
-   size_t n = 0;
-
-   if ( nWrite < logicalPageSize - pageOffset )
-   {
-      n = static_cast<size_t>( nWrite );
-   }
-   else
+   if ( cHeadSize > 0 )
    {
-      n = logicalPageSize - pageOffset;
+      writeAt( offset, zeros.data(), cHeadSize );
+
+      offset += cHeadSize;
+      nWrite -= cHeadSize;
    }
 
-   // Allocate temp page buffer
-   std::vector<char> page_buffer_v( physicalPageSize );
-   char *page_buffer = page_buffer_v.data();
+   // If there are more whole pages than fit in the write buffer, reserve them without writing
+   // anything. They are written when data is written to them, or as zero pages on close().
+   const uint64_t cWholePages = nWrite / logicalPageSize;
 
-   while ( nWrite > 0 )
+   if ( cWholePages >= maxWritePages )
    {
-      const uint64_t physicalLength = length( Physical );
+      const uint64_t cFirstPage = offset / logicalPageSize;
 
-      if ( page * physicalPageSize < physicalLength )
-      {
-         readPhysicalPage( page_buffer, page );
-      }
+      // The new pages need to follow what is on disk, so write out the buffer first
+      flushWriteBuffer();
+
+      reserveZeroPages( cFirstPage, cWholePages );
 
+      offset += cWholePages * logicalPageSize;
+      nWrite -= cWholePages * logicalPageSize;
+
+      logicalLength_ = offset;
+   }
+
+   // Write any remaining zeros through the write buffer
+   while ( nWrite > 0 )
+   {
 #ifdef E57_VERBOSE
-      // cout << "extend " << n << "bytes on page=" << page << " pageOffset=" <<
-      // pageOffset << std::endl;
+      // cout << "extend " << nWrite << "bytes at offset=" << offset << std::endl;
       // //???
 #endif
-      memset( page_buffer + pageOffset, 0, n );
-      writePhysicalPage( page_buffer, page );
+      const auto n = static_cast<size_t>( std::min<uint64_t>( nWrite, logicalPageSize ) );
 
-      nWrite -= n;
-      pageOffset = 0;
-      ++page;
+      writeAt( offset, zeros.data(), n );
 
-      if ( nWrite < logicalPageSize )
-      {
-         n = static_cast<size_t>( nWrite );
-      }
-      else
-      {
-         n = logicalPageSize;
-      }
+      offset += n;
+      nWrite -= n;
    }
 
-   //??? what if loop above throws, logicalLength_ may be wrong
-   logicalLength_ = newLogicalLength;
-
    // When done, leave cursor at end of file
    seek( newLogicalLength, Logical );
 }
 
 void CheckedFile::close()
 {
+   // Finish verifying everything we have read. Report a failure after we've closed the file.
+   stopBackgroundVerify();
+
+   stopPrefetch();
+
+   std::exception_ptr verifyError = verifyError_;
+   verifyError_ = nullptr;
+
+   if ( device_ )
+   {
+      flushWriteBuffer();
+      writeZeroPages();
+
+      // The device belongs to the caller, so just let go of it
+      device_.reset();
+   }
+
    if ( fd_ >= 0 )
    {
+      // Write out anything left in the write buffer before closing
+      flushWriteBuffer();
+      writeZeroPages();
+
+#ifdef E57_IO_URING
+      stopIoUring();
+#endif
+
 #if defined( _MSC_VER )
       int result = ::_close( fd_ );
 #elif defined( __GNUC__ )
@@ -711,11 +1289,30 @@ void CheckedFile::close()
 
       // WARNING: do NOT delete buffer of bufView_ because
       // pointer is handled by user !!
+      // (unless we created it by mapping the file)
+      unmapFile();
+   }
+
+   if ( verifyError != nullptr )
+   {
+      std::rethrow_exception( verifyError );
    }
 }
 
 void CheckedFile::unlink()
 {
+   // No point writing out buffered pages for a file we are about to remove
+   writeBufferPages_ = 0;
+   writeBufferDirty_ = false;
+   zeroPages_.clear();
+
+   // There's no file to remove if we are using a device. Leave its contents to the caller.
+   if ( device_ )
+   {
+      close();
+      return;
+   }
+
    close();
 
    // Try to remove the file, don't report a failure
@@ -730,11 +1327,38 @@ void CheckedFile::unlink()
 #endif
 }
 
-void CheckedFile::verifyChecksum( char *page_buffer, uint64_t page )
+IOStatistics CheckedFile::statistics() const
+{
+   std::lock_guard<std::mutex> readLock( readMutex_ );
+
+   IOStatistics stats = stats_;
+
+   std::lock_guard<std::mutex> lock( verifyMutex_ );
+
+   stats.pagesVerified += verifyStats_.pagesVerified;
+   stats.checksumNanoseconds += verifyStats_.checksumNanoseconds;
+
+   std::lock_guard<std::mutex> prefetchLock( prefetchMutex_ );
+
+   stats.readCalls += prefetchStats_.readCalls;
+   stats.ioNanoseconds += prefetchStats_.ioNanoseconds;
+
+   return stats;
+}
+
+void CheckedFile::verifyChecksum( const char *page_buffer, uint64_t page )
+{
+   checkChecksum( page_buffer, page );
+
+   markVerifiedPage( page );
+}
+
+void CheckedFile::checkChecksum( const char *page_buffer, uint64_t page ) const
 {
    const uint32_t check_sum = checksum( page_buffer, logicalPageSize );
-   const uint32_t check_sum_in_page =
-      *reinterpret_cast<uint32_t *>( &page_buffer[logicalPageSize] );
+   uint32_t check_sum_in_page = 0;
+
+   memcpy( &check_sum_in_page, &page_buffer[logicalPageSize], sizeof( check_sum_in_page ) );
 
    if ( check_sum_in_page != check_sum )
    {
@@ -747,83 +1371,846 @@ void CheckedFile::verifyChecksum( char *page_buffer, uint64_t page )
    }
 }
 
-void CheckedFile::getCurrentPageAndOffset( uint64_t &page, size_t &pageOffset, OffsetMode omode )
+bool CheckedFile::isVerifiedPage( uint64_t page ) const
 {
-   const uint64_t pos = position( omode );
+   return ( page < verifiedPages_.size() ) && verifiedPages_[static_cast<size_t>( page )];
+}
 
-   if ( omode == Physical )
-   {
-      page = pos >> physicalPageSizeLog2;
-      pageOffset = static_cast<size_t>( pos & physicalPageSizeMask );
-   }
-   else
+void CheckedFile::markVerifiedPage( uint64_t page )
+{
+   // Only read-only files track verified pages (see verifiedPages_)
+   if ( page < verifiedPages_.size() )
    {
-      page = pos / logicalPageSize;
-      pageOffset = static_cast<size_t>( pos - page * logicalPageSize );
+      verifiedPages_[static_cast<size_t>( page )] = true;
    }
 }
 
+void CheckedFile::startBackgroundVerify()
+{
+   verifyThread_ = std::thread( &CheckedFile::backgroundVerify, this );
+}
+
+void CheckedFile::stopBackgroundVerify()
+{
+   if ( !verifyThread_.joinable() )
+   {
+      return;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock( verifyMutex_ );
+
+      verifyStop_ = true;
+   }
+
+   verifyCondition_.notify_all();
+
+   verifyThread_.join();
+}
+
+// Runs on verifyThread_ until stopBackgroundVerify() is called and the queue is empty.
+void CheckedFile::backgroundVerify()
+{
+   std::unique_lock<std::mutex> lock( verifyMutex_ );
+
+   for ( ;; )
+   {
+      verifyCondition_.wait( lock, [this] { return verifyStop_ || !verifyQueue_.empty(); } );
+
+      if ( verifyQueue_.empty() )
+      {
+         return;
+      }
+
+      VerifyJob job = std::move( verifyQueue_.front() );
+      verifyQueue_.pop_front();
+
+      // Once we've found a bad page, there's no need to look for more
+      const bool cVerify = ( verifyError_ == nullptr );
+
+      lock.unlock();
+
+      std::exception_ptr error;
+      const Clock::time_point cStart = Clock::now();
+
+      if ( cVerify )
+      {
+         try
+         {
+            for ( size_t i = 0; i < job.pages.size(); ++i )
+            {
+               // Pages in memory are checked where they are (see readAt())
+               const char *page_buffer =
+                  job.buffer.empty()
+                     ? bufView_->data( job.pages[i] * physicalPageSize, physicalPageSize )
+                     : &job.buffer[i * physicalPageSize];
+
+               checkChecksum( page_buffer, job.pages[i] );
+            }
+         }
+         catch ( ... )
+         {
+            error = std::current_exception();
+         }
+      }
+
+      const uint64_t cNanoseconds = nanosecondsSince( cStart );
+
+      lock.lock();
+
+      verifyQueuePages_ -= job.pages.size();
+
+      if ( cVerify )
+      {
+         verifyStats_.pagesVerified += job.pages.size();
+         verifyStats_.checksumNanoseconds += cNanoseconds;
+      }
+
+      if ( ( error != nullptr ) && ( verifyError_ == nullptr ) )
+      {
+         verifyError_ = error;
+      }
+
+      // Wake up readAt() if it is waiting for room in the queue
+      verifyCondition_.notify_all();
+   }
+}
+
+void CheckedFile::checkBackgroundVerifyError()
+{
+   std::lock_guard<std::mutex> lock( verifyMutex_ );
+
+   if ( verifyError_ != nullptr )
+   {
+      std::rethrow_exception( verifyError_ );
+   }
+}
+
+void CheckedFile::getPageAndOffset( uint64_t logicalOffset, uint64_t &page, size_t &pageOffset )
+{
+   page = logicalOffset / logicalPageSize;
+   pageOffset = static_cast<size_t>( logicalOffset - page * logicalPageSize );
+}
+
 void CheckedFile::readPhysicalPage( char *page_buffer, uint64_t page )
+{
+   readPhysicalPages( page_buffer, page, 1 );
+}
+
+void CheckedFile::readPhysicalPages( char *page_buffer, uint64_t page, size_t pageCount )
 {
 #ifdef E57_VERBOSE
-   // cout << "readPhysicalPage, page:" << page << std::endl;
+   // cout << "readPhysicalPages, page:" << page << " pageCount:" << pageCount << std::endl;
 #endif
 
 #ifdef E57_CHECK_FILE_DEBUG
    const uint64_t physicalLength = length( Physical );
 
-   assert( page * physicalPageSize < physicalLength );
+   assert( ( page + pageCount ) * physicalPageSize <= physicalLength );
 #endif
 
-   // Seek to start of physical page
-   seek( page * physicalPageSize, Physical );
+   const uint64_t cOffset = page * physicalPageSize;
+   const size_t cReadSize = pageCount * physicalPageSize;
+
+   stats_.pagesRead += pageCount;
 
    if ( ( fd_ < 0 ) && ( bufView_ != nullptr ) )
    {
-      bufView_->read( page_buffer, physicalPageSize );
+      bufView_->read( cOffset, page_buffer, cReadSize );
+
+      stats_.bytesCopied += cReadSize;
       return;
    }
 
-#if defined( _MSC_VER )
-   int result = ::_read( fd_, page_buffer, physicalPageSize );
-#elif defined( __GNUC__ )
-   ssize_t result = ::read( fd_, page_buffer, physicalPageSize );
-#else
-#error "no supported compiler defined"
+#ifdef E57_IO_URING
+   if ( ioUring_ )
+   {
+      // Make sure we aren't reading pages which are still being written
+      waitForWriteBehind();
+   }
+#endif
+
+   // prefetch_ may be set up by a reader on another thread, so check the flag
+   if ( prefetchStarted_ && readFromPrefetch( page_buffer, page, pageCount ) )
+   {
+#ifdef E57_IO_URING
+      if ( ioUring_ )
+      {
+         startReadAhead( page + pageCount - 1 );
+      }
+#endif
+      return;
+   }
+
+   // pread() may return less than we asked for, so loop until we have the whole run
+   const Clock::time_point cStart = Clock::now();
+   size_t totalRead = 0;
+
+   while ( totalRead < cReadSize )
+   {
+      const int64_t result =
+         pread64( page_buffer + totalRead, cReadSize - totalRead, cOffset + totalRead );
+
+      ++stats_.readCalls;
+
+      if ( result <= 0 )
+      {
+         throw E57_EXCEPTION2( ErrorReadFailed, "fileName=" + fileName_ +
+                                                   " result=" + toString( result ) +
+                                                   " page=" + toString( page ) +
+                                                   " pageCount=" + toString( pageCount ) );
+      }
+
+      totalRead += static_cast<size_t>( result );
+   }
+
+   stats_.ioNanoseconds += nanosecondsSince( cStart );
+
+#ifdef E57_IO_URING
+   if ( ioUring_ && readOnly_ )
+   {
+      startReadAhead( page + pageCount - 1 );
+   }
+#endif
+}
+
+void CheckedFile::prefetch( uint64_t logicalOffset, uint64_t logicalLength )
+{
+   // Only useful if reads go to the OS or a device
+   if ( !readOnly_ || ( logicalLength == 0 ) || ( bufView_ != nullptr ) )
+   {
+      return;
+   }
+
+   const uint64_t cChunkBytes = cPrefetchChunkPages * physicalPageSize;
+   const uint64_t cFirstChunk = logicalToPhysical( logicalOffset ) / cChunkBytes;
+   const uint64_t cLastChunk = logicalToPhysical( logicalOffset + logicalLength - 1 ) / cChunkBytes;
+
+   queuePrefetch( cFirstChunk, cLastChunk + 1 );
+}
+
+// Start reading chunks [firstChunk, endChunk) into prefetch_, as many as fit, unless they are
+// already there or on their way.
+void CheckedFile::queuePrefetch( uint64_t firstChunk, uint64_t endChunk )
+{
+   const uint64_t cChunkBytes = cPrefetchChunkPages * physicalPageSize;
+   const uint64_t cChunkCount = ( physicalLength_ + cChunkBytes - 1 ) / cChunkBytes;
+   const uint64_t cEndChunk =
+      std::min<uint64_t>( { endChunk, firstChunk + cPrefetchChunks, cChunkCount } );
+
+   if ( firstChunk >= cEndChunk )
+   {
+      return;
+   }
+
+   std::unique_lock<std::mutex> lock( prefetchMutex_ );
+
+   bool useIoUring = false;
+
+#ifdef E57_IO_URING
+   useIoUring = ( ioUring_ != nullptr );
+#endif
+
+   if ( !prefetchStarted_ )
+   {
+      prefetch_.resize( cPrefetchChunks );
+
+      for ( auto &chunk : prefetch_ )
+      {
+         chunk.buffer.resize( cChunkBytes );
+      }
+
+      if ( !useIoUring )
+      {
+         prefetchThread_ = std::thread( &CheckedFile::prefetchChunks, this );
+      }
+
+      prefetchStarted_ = true;
+   }
+
+   const auto isInWindow = [firstChunk, cEndChunk]( const PrefetchChunk &chunk ) {
+      return ( chunk.inFlight || chunk.ready ) && ( chunk.chunk >= firstChunk ) &&
+             ( chunk.chunk < cEndChunk );
+   };
+
+   bool queued = false;
+
+   for ( uint64_t chunkIndex = firstChunk; chunkIndex < cEndChunk; ++chunkIndex )
+   {
+      const bool cHaveChunk = std::any_of(
+         prefetch_.begin(), prefetch_.end(), [chunkIndex]( const PrefetchChunk &chunk ) {
+            return ( chunk.inFlight || chunk.ready ) && ( chunk.chunk == chunkIndex );
+         } );
+
+      if ( cHaveChunk )
+      {
+         continue;
+      }
+
+      // Reuse a slot holding a chunk outside the window which nobody is waiting for. A chunk
+      // belongs to prefetchThread_ while it reads it, but we can wait for a read by io_uring.
+      auto slot = std::find_if( prefetch_.begin(), prefetch_.end(),
+                                [&isInWindow, useIoUring]( const PrefetchChunk &chunk ) {
+                                   return ( !chunk.inFlight || useIoUring ) &&
+                                          ( chunk.readers == 0 ) && !isInWindow( chunk );
+                                } );
+
+      if ( slot == prefetch_.end() )
+      {
+         break;
+      }
+
+      if ( slot->inFlight )
+      {
+         waitForChunk( *slot, lock );
+      }
+
+      const auto cSlotIndex = static_cast<size_t>( slot - prefetch_.begin() );
+      const uint64_t cChunkOffset = chunkIndex * cChunkBytes;
+
+      slot->chunk = chunkIndex;
+      slot->size = static_cast<size_t>( std::min( cChunkBytes, physicalLength_ - cChunkOffset ) );
+      slot->ready = false;
+      slot->inFlight = true;
+
+#ifdef E57_IO_URING
+      if ( useIoUring )
+      {
+         // If the ring is full, the chunk is read normally when it is needed
+         slot->inFlight =
+            ioUring_->queueRead( fd_, slot->buffer.data(), slot->size, cChunkOffset, cSlotIndex );
+
+         queued = queued || slot->inFlight;
+         continue;
+      }
+#endif
+
+      prefetchQueue_.push_back( cSlotIndex );
+
+      queued = true;
+   }
+
+   if ( !queued )
+   {
+      return;
+   }
+
+#ifdef E57_IO_URING
+   if ( useIoUring )
+   {
+      ioUring_->submit();
+
+      ++prefetchStats_.readCalls;
+      return;
+   }
+#endif
+
+   prefetchCondition_.notify_all();
+}
+
+void CheckedFile::stopPrefetch()
+{
+   if ( !prefetchStarted_ )
+   {
+      return;
+   }
+
+#ifdef E57_IO_URING
+   if ( ioUring_ )
+   {
+      // The kernel may still be reading into prefetch_
+      std::unique_lock<std::mutex> lock( prefetchMutex_ );
+
+      for ( auto &chunk : prefetch_ )
+      {
+         if ( chunk.inFlight )
+         {
+            waitForChunk( chunk, lock );
+         }
+      }
+
+      prefetchStarted_ = false;
+      return;
+   }
+#endif
+
+   {
+      std::lock_guard<std::mutex> lock( prefetchMutex_ );
+
+      prefetchStop_ = true;
+   }
+
+   prefetchCondition_.notify_all();
+
+   prefetchThread_.join();
+
+   prefetchStarted_ = false;
+}
+
+// Runs on prefetchThread_ until stopPrefetch() is called.
+void CheckedFile::prefetchChunks()
+{
+   std::unique_lock<std::mutex> lock( prefetchMutex_ );
+
+   for ( ;; )
+   {
+      prefetchCondition_.wait( lock, [this] { return prefetchStop_ || !prefetchQueue_.empty(); } );
+
+      if ( prefetchStop_ )
+      {
+         return;
+      }
+
+      // prefetch() only reuses chunks which aren't in flight, so we own this one until we're done
+      PrefetchChunk &chunk = prefetch_[prefetchQueue_.front()];
+      prefetchQueue_.pop_front();
+
+      const uint64_t cOffset = chunk.chunk * cPrefetchChunkPages * physicalPageSize;
+      const size_t cSize = chunk.size;
+      char *buffer = chunk.buffer.data();
+
+      lock.unlock();
+
+      // If the read fails, readAt() will read it again normally and report any error
+      uint64_t readCalls = 0;
+      size_t totalRead = 0;
+
+      while ( totalRead < cSize )
+      {
+         const int64_t result =
+            pread64( buffer + totalRead, cSize - totalRead, cOffset + totalRead );
+
+         ++readCalls;
+
+         if ( result <= 0 )
+         {
+            break;
+         }
+
+         totalRead += static_cast<size_t>( result );
+      }
+
+      lock.lock();
+
+      chunk.inFlight = false;
+      chunk.ready = ( totalRead == cSize );
+
+      // Only count the calls: time spent waiting for them is counted by waitForChunk()
+      prefetchStats_.readCalls += readCalls;
+
+      // Wake up waitForChunk() if it is waiting for this chunk
+      prefetchCondition_.notify_all();
+   }
+}
+
+// Wait for the read of a chunk in prefetch_ to finish. lock holds prefetchMutex_.
+void CheckedFile::waitForChunk( PrefetchChunk &chunk, std::unique_lock<std::mutex> &lock )
+{
+   const Clock::time_point cStart = Clock::now();
+
+#ifdef E57_IO_URING
+   if ( ioUring_ )
+   {
+      // Only the thread holding prefetchMutex_ reads with the ring, so we can wait for it here
+      const auto cSlotIndex = static_cast<uint64_t>( &chunk - prefetch_.data() );
+      const int32_t result = ioUring_->wait( cSlotIndex );
+
+      chunk.inFlight = false;
+      chunk.ready = ( result >= 0 ) && ( static_cast<size_t>( result ) == chunk.size );
+
+      prefetchStats_.ioNanoseconds += nanosecondsSince( cStart );
+      return;
+   }
 #endif
 
-   if ( result < 0 || static_cast<size_t>( result ) != physicalPageSize )
+   // Waiting releases the lock, and another reader's prefetch() may then reuse any slot which
+   // isn't in flight, so pin the chunk while we wait.
+   ++chunk.readers;
+
+   prefetchCondition_.wait( lock, [this, &chunk] { return prefetchStop_ || !chunk.inFlight; } );
+
+   --chunk.readers;
+
+   prefetchStats_.ioNanoseconds += nanosecondsSince( cStart );
+}
+
+bool CheckedFile::readFromPrefetch( char *page_buffer, uint64_t page, size_t pageCount )
+{
+   const uint64_t cFirstChunk = page / cPrefetchChunkPages;
+   const uint64_t cLastChunk = ( page + pageCount - 1 ) / cPrefetchChunkPages;
+
+   std::unique_lock<std::mutex> lock( prefetchMutex_ );
+
+   uint64_t pagesCopied = 0;
+
+   // Copy each chunk as soon as it is ready
+   for ( uint64_t chunkIndex = cFirstChunk; chunkIndex <= cLastChunk; ++chunkIndex )
    {
-      throw E57_EXCEPTION2( ErrorReadFailed,
-                            "fileName=" + fileName_ + " result=" + toString( result ) );
+      auto found = std::find_if( prefetch_.begin(), prefetch_.end(),
+                                 [chunkIndex]( const PrefetchChunk &chunk ) {
+                                    return ( chunk.inFlight || chunk.ready ) &&
+                                           ( chunk.chunk == chunkIndex );
+                                 } );
+
+      if ( found == prefetch_.end() )
+      {
+         return false;
+      }
+
+      if ( found->inFlight )
+      {
+         waitForChunk( *found, lock );
+      }
+
+      if ( !found->ready )
+      {
+         return false;
+      }
+
+      const uint64_t cChunkStart = chunkIndex * cPrefetchChunkPages;
+      const uint64_t cCopyStart = std::max( page, cChunkStart );
+      const uint64_t cCopyEnd =
+         std::min<uint64_t>( page + pageCount, cChunkStart + cPrefetchChunkPages );
+      const auto cCopySize = static_cast<size_t>( cCopyEnd - cCopyStart ) * physicalPageSize;
+
+      memcpy( page_buffer + ( cCopyStart - page ) * physicalPageSize,
+              &found->buffer[( cCopyStart - cChunkStart ) * physicalPageSize], cCopySize );
+
+      pagesCopied += cCopyEnd - cCopyStart;
+   }
+
+   // If anything is missing, readPhysicalPages() reads the whole run itself, so only count the
+   // copies once we know they are all used
+   if ( pagesCopied != pageCount )
+   {
+      return false;
    }
+
+   stats_.bytesCopied += pageCount * physicalPageSize;
+
+   return true;
 }
 
 void CheckedFile::writePhysicalPage( char *page_buffer, uint64_t page )
+{
+   writePhysicalPages( page_buffer, page, 1 );
+}
+
+void CheckedFile::writePhysicalPages( char *page_buffer, uint64_t page, size_t pageCount )
 {
 #ifdef E57_VERBOSE
-   // cout << "writePhysicalPage, page:" << page << std::endl;
+   // cout << "writePhysicalPages, page:" << page << " pageCount:" << pageCount << std::endl;
 #endif
 
-   // Append checksum
-   uint32_t check_sum = checksum( page_buffer, logicalPageSize );
-   *reinterpret_cast<uint32_t *>( &page_buffer[logicalPageSize] ) =
-      check_sum; //??? little endian dependency
+   // Append checksums
+   const Clock::time_point cStart = Clock::now();
+
+   for ( size_t i = 0; i < pageCount; ++i )
+   {
+      char *pageStart = page_buffer + i * physicalPageSize;
 
-   // Seek to start of physical page
-   seek( page * physicalPageSize, Physical );
+      uint32_t check_sum = checksum( pageStart, logicalPageSize );
+      *reinterpret_cast<uint32_t *>( &pageStart[logicalPageSize] ) =
+         check_sum; //??? little endian dependency
+   }
 
-#if defined( _MSC_VER )
-   int result = ::_write( fd_, page_buffer, physicalPageSize );
-#elif defined( __GNUC__ )
-   ssize_t result = ::write( fd_, page_buffer, physicalPageSize );
-#else
-#error "no supported compiler defined"
+   stats_.checksumNanoseconds += nanosecondsSince( cStart );
+
+   writeChecksummedPages( page_buffer, page, pageCount );
+}
+
+void CheckedFile::writeChecksummedPages( const char *page_buffer, uint64_t page, size_t pageCount )
+{
+#ifdef E57_IO_URING
+   // Make sure this write lands after any write still in progress
+   waitForWriteBehind();
 #endif
 
-   if ( result < 0 )
+   const uint64_t cOffset = page * physicalPageSize;
+   const size_t cWriteSize = pageCount * physicalPageSize;
+
+   // pwrite() may write less than we asked for, so loop until the whole run is written
+   const Clock::time_point cStart = Clock::now();
+   size_t totalWritten = 0;
+
+   while ( totalWritten < cWriteSize )
+   {
+      const int64_t result =
+         pwrite64( page_buffer + totalWritten, cWriteSize - totalWritten, cOffset + totalWritten );
+
+      ++stats_.writeCalls;
+
+      if ( result <= 0 )
+      {
+         throw E57_EXCEPTION2( ErrorWriteFailed, "fileName=" + fileName_ +
+                                                    " result=" + toString( result ) +
+                                                    " page=" + toString( page ) +
+                                                    " pageCount=" + toString( pageCount ) );
+      }
+
+      totalWritten += static_cast<size_t>( result );
+   }
+
+   stats_.ioNanoseconds += nanosecondsSince( cStart );
+   stats_.pagesWritten += pageCount;
+
+   physicalLength_ = std::max( physicalLength_, cOffset + cWriteSize );
+}
+
+char *CheckedFile::bufferedPage( uint64_t page )
+{
+   // Grow the buffer with zeroed pages until it holds the page, writing it out when it's full
+   while ( page >= writeBufferPage_ + writeBufferPages_ )
+   {
+      if ( writeBufferPages_ == maxWritePages )
+      {
+         flushWriteBuffer();
+         continue;
+      }
+
+      memset( &writeBuffer_[writeBufferPages_ * physicalPageSize], 0, physicalPageSize );
+
+      ++writeBufferPages_;
+
+      physicalLength_ =
+         std::max( physicalLength_, ( writeBufferPage_ + writeBufferPages_ ) * physicalPageSize );
+   }
+
+   return &writeBuffer_[static_cast<size_t>( page - writeBufferPage_ ) * physicalPageSize];
+}
+
+void CheckedFile::flushWriteBuffer()
+{
+   if ( writeBufferPages_ == 0 )
    {
-      throw E57_EXCEPTION2( ErrorWriteFailed,
-                            "fileName=" + fileName_ + " result=" + toString( result ) );
+      return;
+   }
+
+   if ( writeBufferDirty_ )
+   {
+#ifdef E57_IO_URING
+      if ( ioUring_ )
+      {
+         writeBehind();
+      }
+      else
+#endif
+      {
+         writePhysicalPages( writeBuffer_.data(), writeBufferPage_, writeBufferPages_ );
+      }
+
+      writeBufferDirty_ = false;
+   }
+
+   // Keep the last page if it is only partly filled since the next write will probably add to it.
+   const uint64_t lastPage = writeBufferPage_ + writeBufferPages_ - 1;
+
+   if ( logicalLength_ < ( lastPage + 1 ) * logicalPageSize )
+   {
+      memmove( writeBuffer_.data(), &writeBuffer_[( writeBufferPages_ - 1 ) * physicalPageSize],
+               physicalPageSize );
+
+      writeBufferPage_ = lastPage;
+      writeBufferPages_ = 1;
+   }
+   else
+   {
+      writeBufferPage_ = lastPage + 1;
+      writeBufferPages_ = 0;
    }
 }
+
+void CheckedFile::reserveZeroPages( uint64_t page, uint64_t pageCount )
+{
+   // Make the file longer without writing anything. On most file systems this leaves a hole.
+   const uint64_t cNewPhysicalLength = ( page + pageCount ) * physicalPageSize;
+
+   ftruncate64( cNewPhysicalLength );
+
+   physicalLength_ = std::max( physicalLength_, cNewPhysicalLength );
+
+   if ( zeroPages_.empty() )
+   {
+      zeroPagesStart_ = page;
+   }
+
+   zeroPages_.resize( static_cast<size_t>( page + pageCount - zeroPagesStart_ ), false );
+
+   std::fill( zeroPages_.begin() + static_cast<std::ptrdiff_t>( page - zeroPagesStart_ ),
+              zeroPages_.end(), true );
+
+   // The write buffer now starts after the reserved pages
+   writeBufferPage_ = page + pageCount;
+}
+
+bool CheckedFile::isZeroPage( uint64_t page ) const
+{
+   return ( page >= zeroPagesStart_ ) && ( page - zeroPagesStart_ < zeroPages_.size() ) &&
+          zeroPages_[static_cast<size_t>( page - zeroPagesStart_ )];
+}
+
+void CheckedFile::writeZeroPages()
+{
+   if ( zeroPages_.empty() )
+   {
+      return;
+   }
+
+   // Fill the write buffer with zero pages. Every one has the same checksum.
+   static const uint32_t sZeroPageChecksum =
+      checksum( std::vector<char>( logicalPageSize, 0 ).data(), logicalPageSize );
+
+   std::fill( writeBuffer_.begin(), writeBuffer_.end(), 0 );
+
+   for ( size_t i = 0; i < maxWritePages; ++i )
+   {
+      *reinterpret_cast<uint32_t *>( &writeBuffer_[i * physicalPageSize + logicalPageSize] ) =
+         sZeroPageChecksum; //??? little endian dependency
+   }
+
+   // Write each run of reserved pages which never had data written to them
+   size_t i = 0;
+
+   while ( i < zeroPages_.size() )
+   {
+      if ( !zeroPages_[i] )
+      {
+         ++i;
+         continue;
+      }
+
+      size_t runPages = 1;
+
+      while ( ( runPages < maxWritePages ) && ( i + runPages < zeroPages_.size() ) &&
+              zeroPages_[i + runPages] )
+      {
+         ++runPages;
+      }
+
+      writeChecksummedPages( writeBuffer_.data(), zeroPagesStart_ + i, runPages );
+
+      i += runPages;
+   }
+
+   zeroPages_.clear();
+}
+
+#ifdef E57_IO_URING
+void CheckedFile::startIoUring()
+{
+   ioUring_.reset( new IoUring( 2 * cPrefetchChunks ) );
+
+   // If the kernel doesn't support io_uring, fall back to regular I/O
+   if ( !ioUring_->isValid() )
+   {
+      ioUring_.reset();
+      return;
+   }
+
+   // Reads go through prefetch_ (see queuePrefetch())
+   if ( !readOnly_ )
+   {
+      writeBehind_.resize( writeBuffer_.size() );
+   }
+}
+
+void CheckedFile::stopIoUring()
+{
+   if ( !ioUring_ )
+   {
+      return;
+   }
+
+   // stopPrefetch() has already waited for any reads into prefetch_
+   try
+   {
+      waitForWriteBehind();
+   }
+   catch ( ... )
+   {
+      ioUring_.reset();
+      throw;
+   }
+
+   ioUring_.reset();
+
+   writeBehind_.clear();
+}
+
+void CheckedFile::startReadAhead( uint64_t page )
+{
+   // Keep the chunk containing page and the ones following it in flight
+   const uint64_t cFirstChunk = page / cPrefetchChunkPages;
+
+   queuePrefetch( cFirstChunk, cFirstChunk + cReadAheadChunks );
+}
+
+void CheckedFile::writeBehind()
+{
+   // Append checksums
+   const Clock::time_point cStart = Clock::now();
+
+   for ( size_t i = 0; i < writeBufferPages_; ++i )
+   {
+      char *pageStart = &writeBuffer_[i * physicalPageSize];
+
+      uint32_t check_sum = checksum( pageStart, logicalPageSize );
+      *reinterpret_cast<uint32_t *>( &pageStart[logicalPageSize] ) =
+         check_sum; //??? little endian dependency
+   }
+
+   stats_.checksumNanoseconds += nanosecondsSince( cStart );
+
+   // We only have two buffers, so wait for the previous one
+   waitForWriteBehind();
+
+   writeBuffer_.swap( writeBehind_ );
+
+   writeBehindPage_ = writeBufferPage_;
+   writeBehindPages_ = writeBufferPages_;
+
+   // flushWriteBuffer() may keep the last page, so make sure the write buffer still has it
+   const size_t cLastPageStart = ( writeBufferPages_ - 1 ) * physicalPageSize;
+
+   memcpy( &writeBuffer_[cLastPageStart], &writeBehind_[cLastPageStart], physicalPageSize );
+
+   writeBehindInFlight_ =
+      ioUring_->queueWrite( fd_, writeBehind_.data(), writeBehindPages_ * physicalPageSize,
+                            writeBehindPage_ * physicalPageSize, cWriteBehindUserData );
+
+   if ( writeBehindInFlight_ )
+   {
+      ioUring_->submit();
+
+      ++stats_.writeCalls;
+      stats_.pagesWritten += writeBehindPages_;
+   }
+   else
+   {
+      writeChecksummedPages( writeBehind_.data(), writeBehindPage_, writeBehindPages_ );
+   }
+}
+
+void CheckedFile::waitForWriteBehind()
+{
+   if ( !writeBehindInFlight_ )
+   {
+      return;
+   }
+
+   writeBehindInFlight_ = false;
+
+   const Clock::time_point cStart = Clock::now();
+   const int32_t result = ioUring_->wait( cWriteBehindUserData );
+
+   stats_.ioNanoseconds += nanosecondsSince( cStart );
+
+   // If it failed or only part of it was written, write the whole thing again the normal way.
+   // That reports the error if the file really can't be written.
+   if ( ( result < 0 ) ||
+        ( static_cast<size_t>( result ) < writeBehindPages_ * physicalPageSize ) )
+   {
+      writeChecksummedPages( writeBehind_.data(), writeBehindPage_, writeBehindPages_ );
+   }
+}
+#endif
@@ -28,6 +28,13 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "Common.h"
 
@@ -39,6 +46,10 @@ namespace e57
    // WARNING: pointer input is handled by user!
    class BufferView;
 
+#ifdef E57_IO_URING
+   class IoUring;
+#endif
+
    class CheckedFile
    {
    public:
@@ -48,10 +59,17 @@ namespace e57
       static constexpr uint64_t physicalPageSizeMask = physicalPageSize - 1;
       static constexpr size_t logicalPageSize = physicalPageSize - 4;
 
+      // maximum number of physical pages read() will fetch with a single call
+      static constexpr size_t maxReadPages = 256;
+
+      // number of physical pages at the end of the file that write() buffers before writing them
+      static constexpr size_t maxWritePages = 256;
+
    public:
       enum Mode
       {
          Read,
+         ReadMemoryMap, // read mode, but serve reads from a memory mapping of the file
          Write,
       };
 
@@ -61,21 +79,38 @@ namespace e57
          Physical
       };
 
+      // How a range of the file is about to be accessed (see adviseAccess())
+      enum AccessPattern
+      {
+         AccessNormal,
+         AccessSequential, // will be read from start to end
+         AccessWillNeed,   // will be read soon
+         AccessDontNeed,   // won't be read again
+      };
+
       CheckedFile( const e57::ustring &fileName, Mode mode, ReadChecksumPolicy policy );
       CheckedFile( const char *input, uint64_t size, ReadChecksumPolicy policy );
+      CheckedFile( std::shared_ptr<IODevice> device, Mode mode, ReadChecksumPolicy policy );
       ~CheckedFile();
 
       void read( char *buf, size_t nRead, size_t bufSize = 0 );
+      void readAt( uint64_t logicalOffset, char *buf, size_t nRead );
+      // Returns a pointer to the bytes without copying them if the file is in memory and they
+      // don't cross a page boundary, or nullptr otherwise.
+      const char *readInPlace( uint64_t logicalOffset, size_t nRead );
       void write( const char *buf, size_t nWrite );
+      void writeAt( uint64_t logicalOffset, const char *buf, size_t nWrite );
       CheckedFile &operator<<( const e57::ustring &s );
       CheckedFile &operator<<( int64_t i );
       CheckedFile &operator<<( uint64_t i );
       CheckedFile &operator<<( float f );
       CheckedFile &operator<<( double d );
       void seek( uint64_t offset, OffsetMode omode = Logical );
-      uint64_t position( OffsetMode omode = Logical );
-      uint64_t length( OffsetMode omode = Logical );
+      uint64_t position( OffsetMode omode = Logical ) const;
+      uint64_t length( OffsetMode omode = Logical ) const;
       void extend( uint64_t newLength, OffsetMode omode = Logical );
+      void adviseAccess( uint64_t logicalOffset, uint64_t logicalLength, AccessPattern pattern );
+      void prefetch( uint64_t logicalOffset, uint64_t logicalLength );
 
       e57::ustring fileName() const
       {
@@ -85,30 +120,159 @@ namespace e57
       void close();
       void unlink();
 
+      // Snapshot of the I/O counters (see IOStatistics)
+      IOStatistics statistics() const;
+
       static inline uint64_t logicalToPhysical( uint64_t logicalOffset );
       static inline uint64_t physicalToLogical( uint64_t physicalOffset );
 
    private:
-      void verifyChecksum( char *page_buffer, uint64_t page );
+      void verifyChecksum( const char *page_buffer, uint64_t page );
+      void checkChecksum( const char *page_buffer, uint64_t page ) const;
+      bool isVerifiedPage( uint64_t page ) const;
+      void markVerifiedPage( uint64_t page );
+
+      struct VerifyJob;
+      void checkPages( const char *page_buffer, uint64_t page, size_t pageCount, size_t pageOffset,
+                       size_t nRead, VerifyJob &verifyJob );
+      void queueBackgroundVerify( VerifyJob &verifyJob );
+
+      void startBackgroundVerify();
+      void stopBackgroundVerify();
+      void backgroundVerify();
+      void checkBackgroundVerifyError();
+
+      struct PrefetchChunk;
+      void queuePrefetch( uint64_t firstChunk, uint64_t endChunk );
+      void stopPrefetch();
+      void prefetchChunks();
+      void waitForChunk( PrefetchChunk &chunk, std::unique_lock<std::mutex> &lock );
+      bool readFromPrefetch( char *page_buffer, uint64_t page, size_t pageCount );
 
       template <class FTYPE> CheckedFile &writeFloatingPoint( FTYPE value, int precision );
 
-      void getCurrentPageAndOffset( uint64_t &page, size_t &pageOffset,
-                                    OffsetMode omode = Logical );
+      static void getPageAndOffset( uint64_t logicalOffset, uint64_t &page, size_t &pageOffset );
       void readPhysicalPage( char *page_buffer, uint64_t page );
+      void readPhysicalPages( char *page_buffer, uint64_t page, size_t pageCount );
       void writePhysicalPage( char *page_buffer, uint64_t page );
+      void writePhysicalPages( char *page_buffer, uint64_t page, size_t pageCount );
+      void writeChecksummedPages( const char *page_buffer, uint64_t page, size_t pageCount );
+      char *bufferedPage( uint64_t page );
+      void flushWriteBuffer();
+      void reserveZeroPages( uint64_t page, uint64_t pageCount );
+      bool isZeroPage( uint64_t page ) const;
+      void writeZeroPages();
+
+#ifdef E57_IO_URING
+      void startIoUring();
+      void stopIoUring();
+      void startReadAhead( uint64_t page );
+      void writeBehind();
+      void waitForWriteBehind();
+#endif
+      void mapFile();
+      void unmapFile();
       int open64( const e57::ustring &fileName, int flags, int mode );
       uint64_t lseek64( int64_t offset, int whence );
+      int64_t pread64( char *buf, size_t count, uint64_t physicalOffset );
+      int64_t pwrite64( const char *buf, size_t count, uint64_t physicalOffset );
+      void ftruncate64( uint64_t physicalLength );
 
       e57::ustring fileName_;
       uint64_t logicalLength_ = 0;
       uint64_t physicalLength_ = 0;
 
+      // Physical offset used by read() & write(). We use positional I/O, so this is not shared
+      // with the OS file cursor.
+      uint64_t position_ = 0;
+
       ReadChecksumPolicy checkSumPolicy_ = ChecksumPolicy::ChecksumAll;
 
       int fd_ = -1;
       BufferView *bufView_ = nullptr;
+      void *mapping_ = nullptr; // start of memory mapping if opened with ReadMemoryMap
+      std::shared_ptr<IODevice> device_; // caller's device if opened with one (instead of fd_)
+
+      // Write-combining buffer for the pages at the end of the file being written.
+      // Pages before writeBufferPage_ are on disk. Pages from writeBufferPage_ on only exist
+      // in writeBuffer_ until flushWriteBuffer() is called.
+      std::vector<char> writeBuffer_;
+      uint64_t writeBufferPage_ = 0;  // first page held in writeBuffer_
+      size_t writeBufferPages_ = 0;   // number of pages held in writeBuffer_
+      bool writeBufferDirty_ = false; // writeBuffer_ has changes not yet written to disk
+
+      // Read mode: verifiedPages_[i] is true if the checksum of page i has already been verified,
+      // so we check each page at most once no matter how many times it is read.
+      // (Empty when writing since the pages may change.)
+      std::vector<bool> verifiedPages_;
+
+      // ChecksumBackground: pages read by readAt() waiting to be verified by verifyThread_
+      struct VerifyJob
+      {
+         std::vector<uint64_t> pages;
+         // Copies of the physical pages, in the same order as pages. Empty if the pages are in
+         // bufView_ (which stays valid until the thread is stopped).
+         std::vector<char> buffer;
+      };
+
+      std::thread verifyThread_;
+      mutable std::mutex verifyMutex_; // protects the members below
+      std::condition_variable verifyCondition_;
+      std::deque<VerifyJob> verifyQueue_;
+      size_t verifyQueuePages_ = 0;
+      bool verifyStop_ = false;
+      std::exception_ptr verifyError_; // first checksum failure, thrown by the next read or close()
+      IOStatistics verifyStats_;       // checksums verified by verifyThread_
+
+      // Read mode: chunks of pages requested by prefetch() (and, with io_uring, read ahead of
+      // the last pages read). They are read by io_uring if we have it, or by prefetchThread_.
+      struct PrefetchChunk
+      {
+         uint64_t chunk = 0;
+         size_t size = 0;       // number of bytes requested
+         bool inFlight = false; // queued or being read
+         bool ready = false;
+         int readers = 0; // waitForChunk() calls waiting for this chunk; don't reuse it
+         std::vector<char> buffer;
+      };
+
+      std::thread prefetchThread_;
+      std::atomic<bool> prefetchStarted_{ false }; // set once prefetch_ has been set up
+      mutable std::mutex prefetchMutex_;           // protects the members below
+      std::condition_variable prefetchCondition_;
+      std::vector<PrefetchChunk> prefetch_;
+      std::deque<size_t> prefetchQueue_; // indices in prefetch_ waiting for prefetchThread_
+      bool prefetchStop_ = false;
+      IOStatistics prefetchStats_; // reads started for prefetch_, and time spent waiting for them
+
+      // IODevices are only used from one thread at a time (see IODevice)
+      std::mutex deviceMutex_;
+
+      // Several readers of the same compressed vector may call readAt() and readInPlace() from
+      // different threads (see CompressedVectorNode::readParallel()). This also protects stats_.
+      mutable std::mutex readMutex_;
+
+      // Pages reserved by extend() which are all zeros but have not been written to disk yet.
+      // zeroPages_[i] is true if page (zeroPagesStart_ + i) is one of them.
+      uint64_t zeroPagesStart_ = 0;
+      std::vector<bool> zeroPages_;
+
+#ifdef E57_IO_URING
+      // Write mode: the previous contents of writeBuffer_, being written in the background
+      std::vector<char> writeBehind_;
+      uint64_t writeBehindPage_ = 0;
+      size_t writeBehindPages_ = 0;
+      bool writeBehindInFlight_ = false;
+
+      // Asynchronous I/O using io_uring. nullptr if it is not available at runtime.
+      // Declared after the buffers above (and prefetch_) so it is destroyed (waiting for any I/O
+      // in flight) before they are.
+      std::unique_ptr<IoUring> ioUring_;
+#endif
       bool readOnly_ = false;
+
+      // Counters for statistics(), updated by the thread using the file
+      IOStatistics stats_;
    };
 
    inline uint64_t CheckedFile::logicalToPhysical( uint64_t logicalOffset )
@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: BSL-1.0
+// Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+
+#include <cstring>
+
+#include "CRC.h"
+
+#include "Checksum.h"
+
+#ifdef E57_CRC32C_X86_64
+#include <nmmintrin.h> // SSE4.2
+#include <wmmintrin.h> // PCLMULQDQ
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+// GCC & clang need to be told which functions may use these instructions.
+// MSVC allows intrinsics anywhere.
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define E57_TARGET_SSE42 __attribute__( ( target( "sse4.2" ) ) )
+#define E57_TARGET_SSE42_PCLMUL __attribute__( ( target( "sse4.2,pclmul" ) ) )
+#else
+#define E57_TARGET_SSE42
+#define E57_TARGET_SSE42_PCLMUL
+#endif
+#endif
+
+namespace
+{
+   using CRCFunction = uint32_t ( * )( const char *buf, size_t size );
+
+#ifdef E57_CRC32C_X86_64
+   // CRC-32C polynomial (0x1EDC6F41) in bit-reflected form
+   constexpr uint32_t cPolyReflected = 0x82F63B78;
+
+   // Number of bytes in each of the three interleaved streams used by crc32cSSE42PCLMUL().
+   // 3 * 336 = 1008, so a CheckedFile logical page (1020 bytes) is one block plus a short tail.
+   constexpr size_t cLaneSize = 336;
+
+   inline uint64_t load64( const char *buf )
+   {
+      uint64_t value;
+      memcpy( &value, buf, sizeof( value ) );
+      return value;
+   }
+
+   // Calculate x^n mod P (bit-reflected).
+   uint32_t xPowModP( size_t n )
+   {
+      uint32_t result = 0x80000000; // x^0
+
+      while ( n-- != 0 )
+      {
+         result = ( result & 1 ) ? ( ( result >> 1 ) ^ cPolyReflected ) : ( result >> 1 );
+      }
+
+      return result;
+   }
+
+   // Update a raw (not inverted) CRC using the crc32 instruction one word at a time.
+   E57_TARGET_SSE42 uint32_t updateSSE42( uint32_t crc, const char *buf, size_t size )
+   {
+      uint64_t crc64 = crc;
+
+      while ( size >= sizeof( uint64_t ) )
+      {
+         crc64 = _mm_crc32_u64( crc64, load64( buf ) );
+
+         buf += sizeof( uint64_t );
+         size -= sizeof( uint64_t );
+      }
+
+      crc = static_cast<uint32_t>( crc64 );
+
+      while ( size-- != 0 )
+      {
+         crc = _mm_crc32_u8( crc, static_cast<uint8_t>( *buf++ ) );
+      }
+
+      return crc;
+   }
+
+   // Shift a raw CRC forward over n zero bytes, where k = x^(8n - 33) mod P.
+   // The carry-less product is (crc * k), and crc32 of that gives (crc * k * x^33) mod P.
+   E57_TARGET_SSE42_PCLMUL uint32_t shiftPCLMUL( uint32_t crc, uint32_t k )
+   {
+      const __m128i product = _mm_clmulepi64_si128( _mm_cvtsi32_si128( static_cast<int>( crc ) ),
+                                                    _mm_cvtsi32_si128( static_cast<int>( k ) ), 0 );
+
+      return static_cast<uint32_t>(
+         _mm_crc32_u64( 0, static_cast<uint64_t>( _mm_cvtsi128_si64( product ) ) ) );
+   }
+
+   // The crc32 instruction has a latency of three cycles but a throughput of one per cycle, so
+   // checksum three streams at once and fold them together with carry-less multiplication.
+   E57_TARGET_SSE42_PCLMUL uint32_t updateSSE42PCLMUL( uint32_t crc, const char *buf, size_t size )
+   {
+      static const uint32_t sShift1 = xPowModP( cLaneSize * 8 - 33 );
+      static const uint32_t sShift2 = xPowModP( cLaneSize * 2 * 8 - 33 );
+
+      while ( size >= 3 * cLaneSize )
+      {
+         uint64_t crc0 = crc;
+         uint64_t crc1 = 0;
+         uint64_t crc2 = 0;
+
+         for ( size_t i = 0; i < cLaneSize; i += sizeof( uint64_t ) )
+         {
+            crc0 = _mm_crc32_u64( crc0, load64( buf + i ) );
+            crc1 = _mm_crc32_u64( crc1, load64( buf + cLaneSize + i ) );
+            crc2 = _mm_crc32_u64( crc2, load64( buf + 2 * cLaneSize + i ) );
+         }
+
+         crc = shiftPCLMUL( static_cast<uint32_t>( crc0 ), sShift2 ) ^
+               shiftPCLMUL( static_cast<uint32_t>( crc1 ), sShift1 ) ^
+               static_cast<uint32_t>( crc2 );
+
+         buf += 3 * cLaneSize;
+         size -= 3 * cLaneSize;
+      }
+
+      return updateSSE42( crc, buf, size );
+   }
+
+   // ECX of CPUID leaf 1, which holds the SSE4.2 and PCLMULQDQ feature bits.
+   unsigned int cpuidFeatures()
+   {
+      unsigned int ecx = 0;
+
+#if defined( _MSC_VER )
+      int info[4];
+      __cpuid( info, 1 );
+      ecx = static_cast<unsigned int>( info[2] );
+#else
+      unsigned int eax, ebx, edx;
+      if ( __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) == 0 )
+      {
+         ecx = 0;
+      }
+#endif
+
+      return ecx;
+   }
+#endif
+
+   // Pick the fastest implementation this CPU supports.
+   CRCFunction selectCRCFunction()
+   {
+#ifdef E57_CRC32C_X86_64
+      if ( e57::cpuHasSSE42PCLMUL() )
+      {
+         return e57::crc32cSSE42PCLMUL;
+      }
+
+      if ( e57::cpuHasSSE42() )
+      {
+         return e57::crc32cSSE42;
+      }
+#endif
+
+      return e57::crc32cTable;
+   }
+}
+
+namespace e57
+{
+   uint32_t crc32c( const char *buf, size_t size )
+   {
+      static const CRCFunction sCRCFunction = selectCRCFunction();
+
+      return sCRCFunction( buf, size );
+   }
+
+   uint32_t crc32cTable( const char *buf, size_t size )
+   {
+      static const CRC::Parameters<crcpp_uint32, 32> sCRCParams{ 0x1EDC6F41, 0xFFFFFFFF, 0xFFFFFFFF,
+                                                                 true, true };
+
+      static const CRC::Table<crcpp_uint32, 32> sCRCTable = sCRCParams.MakeTable();
+
+      return CRC::Calculate<crcpp_uint32, 32>( buf, size, sCRCTable );
+   }
+
+#ifdef E57_CRC32C_X86_64
+   bool cpuHasSSE42()
+   {
+      return ( cpuidFeatures() & ( 1u << 20 ) ) != 0;
+   }
+
+   bool cpuHasSSE42PCLMUL()
+   {
+      return cpuHasSSE42() && ( cpuidFeatures() & ( 1u << 1 ) ) != 0;
+   }
+
+   uint32_t crc32cSSE42( const char *buf, size_t size )
+   {
+      return ~updateSSE42( 0xFFFFFFFF, buf, size );
+   }
+
+   uint32_t crc32cSSE42PCLMUL( const char *buf, size_t size )
+   {
+      return ~updateSSE42PCLMUL( 0xFFFFFFFF, buf, size );
+   }
+#endif
+}
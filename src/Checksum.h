@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: BSL-1.0
+// Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// The hardware implementations need the 64-bit crc32 instruction, so only use them on x86-64.
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define E57_CRC32C_X86_64
+#endif
+
+namespace e57
+{
+   /// @brief Calculate the CRC-32C (Castagnoli) checksum of a buffer
+   /// @details Uses the CPU's crc32 instruction (SSE4.2) when it is available at runtime and
+   /// falls back to crc32cTable() otherwise. The result is identical either way.
+   uint32_t crc32c( const char *buf, size_t size );
+
+   /// @brief Calculate the CRC-32C checksum of a buffer using CRCpp's table-driven implementation
+   uint32_t crc32cTable( const char *buf, size_t size );
+
+#ifdef E57_CRC32C_X86_64
+   /// @brief Whether this CPU has the SSE4.2 crc32 instruction needed by crc32cSSE42()
+   bool cpuHasSSE42();
+
+   /// @brief Whether this CPU also has the PCLMULQDQ instruction needed by crc32cSSE42PCLMUL()
+   bool cpuHasSSE42PCLMUL();
+
+   /// @brief Calculate the CRC-32C checksum of a buffer one word at a time with crc32
+   /// @note Only call this if cpuHasSSE42() is true.
+   uint32_t crc32cSSE42( const char *buf, size_t size );
+
+   /// @brief Calculate the CRC-32C checksum of a buffer as three interleaved crc32 streams
+   /// @note Only call this if cpuHasSSE42PCLMUL() is true.
+   uint32_t crc32cSSE42PCLMUL( const char *buf, size_t size );
+#endif
+}
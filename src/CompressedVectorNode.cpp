@@ -459,6 +459,9 @@ IntegerNode, ScaledIntegerNode, FloatNode, StringNode) in this CompressedVectorN
 is an error for two SourceDestBuffers in @a dbufs to identify the same terminal node in the
 prototype. It is not an error to create a CompressedVectorReader for an empty CompressedVectorNode.
 
+Any number of CompressedVectorReaders may be open at the same time. If the ImageFile was opened in
+read mode, they may be used on different threads (each reader by one thread at a time).
+
 @pre @a dbufs can't be empty
 @pre The destination ImageFile must be open (i.e. destImageFile().isOpen()).
 @pre The destination ImageFile can't have any writers open (destImageFile().writerCount()==0)
@@ -483,3 +486,47 @@ CompressedVectorReader CompressedVectorNode::reader( const std::vector<SourceDes
 {
    return CompressedVectorReader( impl_->reader( dbufs ) );
 }
+
+/*!
+@brief Read the records of a CompressedVectorNode using several threads.
+
+@param [in] dbufs Vector of memory buffers that will receive data read from a CompressedVectorNode.
+@param [in] threadCount The number of threads to use. If 0, use one per CPU core.
+
+@details
+Reads the records from the start of the CompressedVectorNode into @a dbufs, up to the capacity of
+the smallest buffer. The same rules apply to @a dbufs as for CompressedVectorNode::reader().
+
+The records are split into ranges (at least 65536 records each), one per thread. Each range is
+decoded by its own reader straight into its slice of the buffers, starting from the nearest chunk
+listed in the index packets (or found by scanning the data packet headers). Unlike a
+CompressedVectorReader, which decodes the records in order, this can use all the cores to read a
+single large scan.
+
+Reading from the file itself is not done in parallel, so this is most useful when decoding is the
+bottleneck (e.g. memory-mapped files or files in the OS cache).
+
+@pre @a dbufs can't be empty
+@pre The destination ImageFile must be open (i.e. destImageFile().isOpen()).
+@pre The destination ImageFile can't have any writers open (destImageFile().writerCount()==0)
+@pre This CompressedVectorNode must be attached (i.e. isAttached()).
+
+@return The number of records read into each buffer.
+
+@throw ::ErrorBadAPIArgument (n/c)
+@throw ::ErrorImageFileNotOpen (n/c)
+@throw ::ErrorTooManyWriters (n/c)
+@throw ::ErrorNodeUnattached (n/c)
+@throw ::ErrorPathUndefined (n/c)
+@throw ::ErrorBufferSizeMismatch (n/c)
+@throw ::ErrorBufferDuplicatePathName (n/c)
+@throw ::ErrorBadCVHeader (n/c)
+@throw ::ErrorInternal All objects in undocumented state
+
+@see CompressedVectorNode::reader, CompressedVectorReader::setDecodeThreadCount
+*/
+uint64_t CompressedVectorNode::readParallel( std::vector<SourceDestBuffer> &dbufs,
+                                             unsigned threadCount )
+{
+   return impl_->readParallel( dbufs, threadCount );
+}
@@ -25,16 +25,76 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
+
 #include "CompressedVectorNodeImpl.h"
 #include "CheckedFile.h"
 #include "CompressedVectorReaderImpl.h"
 #include "CompressedVectorWriterImpl.h"
 #include "ImageFileImpl.h"
+#include "SourceDestBufferImpl.h"
 #include "StringFunctions.h"
+#include "ThreadPool.h"
 #include "VectorNodeImpl.h"
 
 namespace e57
 {
+   /// readParallel() doesn't split the records into ranges smaller than this
+   constexpr uint64_t cMinParallelRangeRecords = 65536;
+
+   /// ...or bigger than this, since each range is read with one read(), which returns an unsigned
+   constexpr uint64_t cMaxParallelRangeRecords = UINT32_MAX;
+
+   namespace
+   {
+      // A buffer for elements [first, first + count) of a (non-string) buffer, using its memory
+      template <typename T>
+      SourceDestBuffer bufferSlice( const ImageFile &imf, const SourceDestBufferImpl &buffer,
+                                    size_t first, size_t count )
+      {
+         auto base = reinterpret_cast<T *>( static_cast<char *>( buffer.base() ) +
+                                            first * buffer.stride() );
+
+         return SourceDestBuffer( imf, buffer.pathName(), base, count, buffer.doConversion(),
+                                  buffer.doScaling(), buffer.stride() );
+      }
+
+      SourceDestBuffer bufferSlice( const ImageFile &imf, const SourceDestBufferImpl &buffer,
+                                    size_t first, size_t count )
+      {
+         switch ( buffer.memoryRepresentation() )
+         {
+            case Int8:
+               return bufferSlice<int8_t>( imf, buffer, first, count );
+            case UInt8:
+               return bufferSlice<uint8_t>( imf, buffer, first, count );
+            case Int16:
+               return bufferSlice<int16_t>( imf, buffer, first, count );
+            case UInt16:
+               return bufferSlice<uint16_t>( imf, buffer, first, count );
+            case Int32:
+               return bufferSlice<int32_t>( imf, buffer, first, count );
+            case UInt32:
+               return bufferSlice<uint32_t>( imf, buffer, first, count );
+            case Int64:
+               return bufferSlice<int64_t>( imf, buffer, first, count );
+            case Bool:
+               return bufferSlice<bool>( imf, buffer, first, count );
+            case Real32:
+               return bufferSlice<float>( imf, buffer, first, count );
+            case Real64:
+               return bufferSlice<double>( imf, buffer, first, count );
+            case UString:
+               break;
+         }
+
+         throw E57_EXCEPTION2( ErrorInternal,
+                               "memoryRepresentation=" +
+                                  toString( static_cast<int>( buffer.memoryRepresentation() ) ) +
+                                  " pathName=" + buffer.pathName() );
+      }
+   }
+
    CompressedVectorNodeImpl::CompressedVectorNodeImpl( ImageFileImplWeakPtr destImageFile ) :
       NodeImpl( destImageFile )
    {
@@ -235,6 +295,119 @@ namespace e57
       cf << space( indent ) << "</" << fieldName << ">\n";
    }
 
+   uint64_t CompressedVectorNodeImpl::readParallel( std::vector<SourceDestBuffer> &dbufs,
+                                                   unsigned threadCount )
+   {
+      checkCanRead( dbufs );
+
+      // Read as many records as there are, or as fit in the smallest buffer
+      uint64_t recordCount = static_cast<uint64_t>( recordCount_ );
+
+      for ( const auto &dbuf : dbufs )
+      {
+         recordCount = std::min<uint64_t>( recordCount, dbuf.capacity() );
+      }
+
+      if ( recordCount == 0 )
+      {
+         return 0;
+      }
+
+      if ( threadCount == 0 )
+      {
+         threadCount = std::max( std::thread::hardware_concurrency(), 1U );
+      }
+
+      // Split the records into one range per thread (unless the ranges would be too small to be
+      // worth it, or too big to read at once)
+      const auto cRangeCount = static_cast<size_t>( std::max<uint64_t>(
+         std::min<uint64_t>( threadCount, ( recordCount + cMinParallelRangeRecords - 1 ) /
+                                             cMinParallelRangeRecords ),
+         ( recordCount + cMaxParallelRangeRecords - 1 ) / cMaxParallelRangeRecords ) );
+
+      std::vector<uint64_t> rangeStarts( cRangeCount + 1 );
+
+      for ( size_t i = 0; i <= cRangeCount; ++i )
+      {
+         rangeStarts[i] = recordCount * i / cRangeCount;
+      }
+
+      // Each range is read into slices of the caller's buffers. Strings are read into a vector of
+      // their own and moved into the caller's afterwards.
+      const ImageFile cImageFile = Node( shared_from_this() ).destImageFile();
+
+      std::vector<std::vector<SourceDestBuffer>> rangeBuffers( cRangeCount );
+      std::vector<std::vector<ustring>> rangeStrings( cRangeCount * dbufs.size() );
+
+      for ( size_t range = 0; range < cRangeCount; ++range )
+      {
+         const auto cFirst = static_cast<size_t>( rangeStarts[range] );
+         const auto cCount = static_cast<size_t>( rangeStarts[range + 1] - cFirst );
+
+         for ( size_t i = 0; i < dbufs.size(); ++i )
+         {
+            const std::shared_ptr<SourceDestBufferImpl> dbuf = dbufs[i].impl();
+
+            if ( dbuf->memoryRepresentation() == UString )
+            {
+               std::vector<ustring> &strings = rangeStrings[range * dbufs.size() + i];
+
+               strings.resize( cCount );
+
+               rangeBuffers[range].emplace_back( cImageFile, dbuf->pathName(), &strings );
+            }
+            else
+            {
+               rangeBuffers[range].push_back( bufferSlice( cImageFile, *dbuf, cFirst, cCount ) );
+            }
+         }
+      }
+
+      // Each range has its own reader, with its own decoders and packet cache
+      std::shared_ptr<CompressedVectorNodeImpl> cai(
+         std::static_pointer_cast<CompressedVectorNodeImpl>( shared_from_this() ) );
+
+      ThreadPool pool( static_cast<unsigned>( std::min<size_t>( cRangeCount, threadCount ) ) );
+
+      pool.run( cRangeCount, [&]( size_t range ) {
+         const uint64_t cCount = rangeStarts[range + 1] - rangeStarts[range];
+
+         CompressedVectorReaderImpl reader( cai, rangeBuffers[range] );
+
+         // Use the chunk index (or scan the packet headers) to find where to start
+         reader.seek( rangeStarts[range] );
+
+         const unsigned cRead = reader.read();
+
+         if ( cRead != cCount )
+         {
+            throw E57_EXCEPTION2( ErrorInternal, "range=" + toString( range ) +
+                                                    " count=" + toString( cCount ) +
+                                                    " read=" + toString( cRead ) );
+         }
+
+         reader.close();
+      } );
+
+      // Move the strings to the caller's buffers
+      for ( size_t range = 0; range < cRangeCount; ++range )
+      {
+         for ( size_t i = 0; i < dbufs.size(); ++i )
+         {
+            std::vector<ustring> &strings = rangeStrings[range * dbufs.size() + i];
+
+            if ( dbufs[i].memoryRepresentation() == UString )
+            {
+               std::move( strings.begin(), strings.end(),
+                          dbufs[i].impl()->ustrings()->begin() +
+                             static_cast<ptrdiff_t>( rangeStarts[range] ) );
+            }
+         }
+      }
+
+      return recordCount;
+   }
+
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
    void CompressedVectorNodeImpl::dump( int indent, std::ostream &os ) const
    {
@@ -317,14 +490,14 @@ namespace e57
       return ( cvwi );
    }
 
-   std::shared_ptr<CompressedVectorReaderImpl> CompressedVectorNodeImpl::reader(
-      std::vector<SourceDestBuffer> dbufs )
+   void CompressedVectorNodeImpl::checkCanRead( const std::vector<SourceDestBuffer> &dbufs )
    {
       checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
 
       ImageFileImplSharedPtr destImageFile( destImageFile_ );
 
-      // Check don't have any writers/readers open for this ImageFile
+      // Check don't have any writers open for this ImageFile. Any number of readers may be open
+      // (on different threads if the ImageFile is read-only).
       if ( destImageFile->writerCount() > 0 )
       {
          throw E57_EXCEPTION2( ErrorTooManyWriters,
@@ -332,13 +505,6 @@ namespace e57
                                   " writerCount=" + toString( destImageFile->writerCount() ) +
                                   " readerCount=" + toString( destImageFile->readerCount() ) );
       }
-      if ( destImageFile->readerCount() > 0 )
-      {
-         throw E57_EXCEPTION2( ErrorTooManyReaders,
-                               "fileName=" + destImageFile->fileName() +
-                                  " writerCount=" + toString( destImageFile->writerCount() ) +
-                                  " readerCount=" + toString( destImageFile->readerCount() ) );
-      }
 
       // dbufs can't be empty
       if ( dbufs.empty() )
@@ -351,6 +517,12 @@ namespace e57
       {
          throw E57_EXCEPTION2( ErrorNodeUnattached, "fileName=" + destImageFile->fileName() );
       }
+   }
+
+   std::shared_ptr<CompressedVectorReaderImpl> CompressedVectorNodeImpl::reader(
+      std::vector<SourceDestBuffer> dbufs )
+   {
+      checkCanRead( dbufs );
 
       // Get pointer to me (really shared_ptr<CompressedVectorNodeImpl>)
       NodeImplSharedPtr ni( shared_from_this() );
@@ -61,6 +61,8 @@ namespace e57
       std::shared_ptr<CompressedVectorWriterImpl> writer( std::vector<SourceDestBuffer> sbufs );
       std::shared_ptr<CompressedVectorReaderImpl> reader( std::vector<SourceDestBuffer> dbufs );
 
+      uint64_t readParallel( std::vector<SourceDestBuffer> &dbufs, unsigned threadCount );
+
       int64_t getRecordCount() const
       {
          return ( recordCount_ );
@@ -88,6 +90,8 @@ namespace e57
    private:
       friend class CompressedVectorReaderImpl;
 
+      void checkCanRead( const std::vector<SourceDestBuffer> &dbufs );
+
       NodeImplSharedPtr prototype_;
       std::shared_ptr<VectorNodeImpl> codecs_;
 
@@ -244,6 +244,55 @@ unsigned CompressedVectorReader::read( std::vector<SourceDestBuffer> &dbufs )
    return impl_->read( dbufs );
 }
 
+/*!
+@brief Request transfer of a range of records from CompressedVectorNode into the previously
+designated destination buffers.
+
+@param [in] startRecord The index of the first record in CompressedVectorNode to read.
+@param [in] count The number of records to read. Must not be more than the capacity of the
+SourceDestBuffers.
+
+@details
+Records @a startRecord to @a startRecord + @a count - 1 are stored at the beginning of the
+SourceDestBuffers, and the rest of the buffers are left untouched. Fewer than @a count records are
+read if the range runs past the end of the CompressedVectorNode.
+
+If @a startRecord is where the previous read stopped, the reader carries on from there just like
+CompressedVectorReader::read(). Otherwise it seeks to @a startRecord first (see
+CompressedVectorReader::seek), so reading a series of ranges in order only decodes each record
+once. Later calls to CompressedVectorReader::read() continue after the range.
+
+Errors during the transfer leave objects in the same states as CompressedVectorReader::read().
+
+@pre @a startRecord <= childCount() of CompressedVectorNode.
+@pre @a count <= capacity of the SourceDestBuffers.
+@pre The associated ImageFile must be open.
+@pre This CompressedVectorReader must be open (i.e isOpen())
+
+@return The number of records read.
+
+@throw ::ErrorBadAPIArgument (n/c)
+@throw ::ErrorImageFileNotOpen (n/c)
+@throw ::ErrorReaderNotOpen (n/c)
+@throw ::ErrorConversionRequired This CompressedVectorReader in undocumented state
+@throw ::ErrorValueNotRepresentable This CompressedVectorReader in undocumented state
+@throw ::ErrorScaledValueNotRepresentable This CompressedVectorReader in undocumented state
+@throw ::ErrorReal64TooLarge This CompressedVectorReader in undocumented state
+@throw ::ErrorExpectingNumeric This CompressedVectorReader in undocumented state
+@throw ::ErrorExpectingUString This CompressedVectorReader in undocumented state
+@throw ::ErrorBadCVPacket This CompressedVectorReader, associated ImageFile in undocumented state
+@throw ::ErrorSeekFailed This CompressedVectorReader, associated ImageFile in undocumented state
+@throw ::ErrorReadFailed This CompressedVectorReader, associated ImageFile in undocumented state
+@throw ::ErrorBadChecksum This CompressedVectorReader, associated ImageFile in undocumented state
+@throw ::ErrorInternal All objects in undocumented state
+
+@see CompressedVectorReader::read(), CompressedVectorReader::seek, CompressedVectorNode::reader
+*/
+unsigned CompressedVectorReader::read( uint64_t startRecord, size_t count )
+{
+   return impl_->read( startRecord, count );
+}
+
 /*!
 @brief Set record number of CompressedVectorNode where next read will start.
 
@@ -255,6 +304,12 @@ This function may be called at any time (as long as ImageFile and CompressedVect
 The next read will start at the given recordNumber. It is not an error to seek to recordNumber =
 childCount() (i.e. to one record past end of CompressedVectorNode).
 
+The reader starts from the closest chunk at or before the record given by the index packets of the
+binary section (or from the first data packet if there is no index), then finds the data packet
+holding the record for each field by reading the headers of the data packets which follow. These
+are remembered, so later seeks within the same chunk don't read them again. Fields whose records
+vary in length (StringNode) are decoded from the start of the chunk up to the record.
+
 @pre @a recordNumber <= childCount() of CompressedVectorNode.
 @pre The associated ImageFile must be open.
 @pre This CompressedVectorReader must be open (i.e isOpen())
@@ -275,6 +330,104 @@ void CompressedVectorReader::seek( int64_t recordNumber )
    impl_->seek( recordNumber );
 }
 
+/*!
+@brief Set the number of data packets the CompressedVectorReader keeps in memory.
+
+@param [in] packetCount The number of packets to keep (at least 1).
+
+@details
+Each field of a record is stored in its own bytestream, and the bytestreams are spread over the
+packets of the binary section. The reader keeps the most recently used packets in a cache so that
+fields which lag behind the others don't cause the same packets to be read again. Files with many
+bytestreams (fields) may benefit from a larger cache.
+
+Each packet may use up to 64 KiB of memory. The default is 32 packets. The cache keeps the most
+recently used packets which fit when it is resized.
+
+@pre The associated ImageFile must be open.
+@pre This CompressedVectorReader must be open (i.e isOpen())
+
+@throw ::ErrorBadAPIArgument (n/c)
+@throw ::ErrorImageFileNotOpen (n/c)
+@throw ::ErrorReaderNotOpen (n/c)
+@throw ::ErrorInternal All objects in undocumented state
+
+@see CompressedVectorReader::packetCacheSize, ReaderOptions::packetCacheSize
+*/
+void CompressedVectorReader::setPacketCacheSize( unsigned packetCount )
+{
+   impl_->setPacketCacheSize( packetCount );
+}
+
+/*!
+@brief Get the number of data packets the CompressedVectorReader keeps in memory.
+
+@pre The associated ImageFile must be open.
+@pre This CompressedVectorReader must be open (i.e isOpen())
+
+@return The size of the packet cache in packets.
+
+@throw ::ErrorImageFileNotOpen (n/c)
+@throw ::ErrorReaderNotOpen (n/c)
+@throw ::ErrorInternal All objects in undocumented state
+
+@see CompressedVectorReader::setPacketCacheSize
+*/
+unsigned CompressedVectorReader::packetCacheSize() const
+{
+   return impl_->packetCacheSize();
+}
+
+/*!
+@brief Set the number of threads used to decode the fields of the records.
+
+@param [in] threadCount The number of threads (at least 1), including the calling thread.
+
+@details
+Each field of a record is stored in its own bytestream with its own decoder, writing to its own
+SourceDestBuffer. When @a threadCount is more than 1, the bytestreams in each data packet are
+decoded in parallel on a pool of threads (@a threadCount - 1 threads are started, and the thread
+calling read() does its share). Reading records with many fields, such as coordinates, intensity,
+color, and time, can then use several cores.
+
+The default is 1: every field is decoded on the thread calling read(). The SourceDestBuffers must
+not overlap in memory when more than one thread is used, since different fields are written at the
+same time. Fields stored in different members of the same structure (using a stride) are fine.
+
+@pre The associated ImageFile must be open.
+@pre This CompressedVectorReader must be open (i.e isOpen())
+
+@throw ::ErrorBadAPIArgument (n/c)
+@throw ::ErrorImageFileNotOpen (n/c)
+@throw ::ErrorReaderNotOpen (n/c)
+@throw ::ErrorInternal All objects in undocumented state
+
+@see CompressedVectorReader::decodeThreadCount, ReaderOptions::decodeThreadCount
+*/
+void CompressedVectorReader::setDecodeThreadCount( unsigned threadCount )
+{
+   impl_->setDecodeThreadCount( threadCount );
+}
+
+/*!
+@brief Get the number of threads used to decode the fields of the records.
+
+@pre The associated ImageFile must be open.
+@pre This CompressedVectorReader must be open (i.e isOpen())
+
+@return The number of threads, including the calling thread.
+
+@throw ::ErrorImageFileNotOpen (n/c)
+@throw ::ErrorReaderNotOpen (n/c)
+@throw ::ErrorInternal All objects in undocumented state
+
+@see CompressedVectorReader::setDecodeThreadCount
+*/
+unsigned CompressedVectorReader::decodeThreadCount() const
+{
+   return impl_->decodeThreadCount();
+}
+
 /*!
 @brief End the read operation.
 
@@ -25,6 +25,9 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
+#include <climits>
+
 #include "CompressedVectorReaderImpl.h"
 #include "CheckedFile.h"
 #include "CompressedVectorNodeImpl.h"
@@ -33,14 +36,22 @@
 #include "SectionHeaders.h"
 #include "SourceDestBufferImpl.h"
 #include "StringFunctions.h"
+#include "ThreadPool.h"
 
 namespace e57
 {
+   /// Size of the window of the binary section we ask the OS to read ahead (and later release)
+   constexpr uint64_t cAdviseChunkSize = 8 * 1024 * 1024;
+
+   /// Number of packets (of at most DATA_PACKET_MAX bytes) read in the background ahead of the
+   /// earliest one being decoded
+   constexpr uint64_t cPrefetchPackets = 4;
+
    CompressedVectorReaderImpl::CompressedVectorReaderImpl(
       std::shared_ptr<CompressedVectorNodeImpl> cvi,
       std::vector<SourceDestBuffer> &dbufs ) :
       isOpen_( false ), // set to true when succeed below
-      cVector_( cvi )
+      cVector_( cvi ), decodePool_( nullptr )
    {
 #ifdef E57_VERBOSE
       std::cout << "CompressedVectorReaderImpl() called" << std::endl; //???
@@ -91,6 +102,7 @@ namespace e57
       }
 
       recordCount_ = 0;
+      nextRecord_ = 0;
 
       // Get how many records are actually defined
       maxRecordCount_ = cvi->childCount();
@@ -118,8 +130,8 @@ namespace e57
 
       // Read CompressedVector section header
       CompressedVectorSectionHeader sectionHeader;
-      imf->file_->seek( sectionLogicalStart, CheckedFile::Logical );
-      imf->file_->read( reinterpret_cast<char *>( &sectionHeader ), sizeof( sectionHeader ) );
+      imf->file_->readAt( sectionLogicalStart, reinterpret_cast<char *>( &sectionHeader ),
+                          sizeof( sectionHeader ) );
 
 #if VALIDATE_BASIC
       sectionHeader.verify( imf->file_->length( CheckedFile::Physical ) );
@@ -128,20 +140,42 @@ namespace e57
       // Pre-calc end of section, so can tell when we are out of packets.
       sectionEndLogicalOffset_ = sectionLogicalStart + sectionHeader.sectionLogicalLength;
 
+      // Tell the OS we will walk through the section front to back, and start reading ahead.
+      imf->file_->adviseAccess( sectionLogicalStart, sectionHeader.sectionLogicalLength,
+                                CheckedFile::AccessSequential );
+      imf->file_->adviseAccess(
+         sectionLogicalStart, std::min( sectionHeader.sectionLogicalLength, cAdviseChunkSize ),
+         CheckedFile::AccessWillNeed );
+
+      releasedLogicalOffset_ = sectionLogicalStart;
+
       // Convert physical offset to first data packet to logical
       uint64_t dataLogicalOffset =
          imf->file_->physicalToLogical( sectionHeader.dataPhysicalOffset );
 
+      dataLogicalOffset_ = dataLogicalOffset;
+
+      // The index is only used by seek()
+      indexLogicalOffset_ = 0;
+
+      if ( sectionHeader.indexPhysicalOffset != 0 )
+      {
+         indexLogicalOffset_ = imf->file_->physicalToLogical( sectionHeader.indexPhysicalOffset );
+      }
+
+      packetMapChunkLogicalOffset_ = 0;
+      packetMapNextLogicalOffset_ = 0;
+
       //??? what if fault in this constructor?
-      cache_ = new PacketReadCache( imf->file_, 32 );
+      cache_ = new PacketReadCache( imf->file_, PacketReadCache::defaultPacketCount );
 
       // Verify that packet given by dataPhysicalOffset is actually a data packet,
       // init channels
       {
-         char *anyPacket = nullptr;
+         const char *anyPacket = nullptr;
          std::unique_ptr<PacketLock> packetLock = cache_->lock( dataLogicalOffset, anyPacket );
 
-         auto dpkt = reinterpret_cast<DataPacket *>( anyPacket );
+         auto dpkt = reinterpret_cast<const DataPacket *>( anyPacket );
 
          // Double check that have a data packet
          if ( dpkt->header.packetType != DATA_PACKET )
@@ -249,12 +283,58 @@ namespace e57
          dbuf.impl()->rewind();
       }
 
+      return decodeRecords();
+   }
+
+   unsigned CompressedVectorReaderImpl::read( uint64_t startRecord, size_t count )
+   {
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      const size_t cCapacity = dbufs_.at( 0 ).impl()->capacity();
+
+      if ( count > cCapacity )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument,
+                               "count=" + toString( count ) + " capacity=" +
+                                  toString( cCapacity ) +
+                                  " imageFileName=" + cVector_->imageFileName() +
+                                  " cvPathName=" + cVector_->pathName() );
+      }
+
+      // A request which follows on from the last read carries on with the decoders' current
+      // state, so only seek when jumping somewhere else.
+      if ( startRecord != nextRecord_ )
+      {
+         seek( startRecord );
+      }
+
+      // Only fill the first count records of the dbufs
+      for ( auto &dbuf : dbufs_ )
+      {
+         dbuf.impl()->rewind( count );
+      }
+
+      return decodeRecords();
+   }
+
+   unsigned CompressedVectorReaderImpl::decodeRecords()
+   {
       // Allow decoders to use data they already have in their queue to fill newly
       // empty dbufs This helps to keep decoder input queues smaller, which
       // reduces backtracking in the packet cache.
-      for ( auto &channel : channels_ )
+      if ( decodePool_ != nullptr )
       {
-         channel.decoder->inputProcess( nullptr, 0 );
+         decodePool_->run( channels_.size(), [this]( size_t i ) {
+            channels_[i].decoder->inputProcess( nullptr, 0 );
+         } );
+      }
+      else
+      {
+         for ( auto &channel : channels_ )
+         {
+            channel.decoder->inputProcess( nullptr, 0 );
+         }
       }
 
       // Loop until every dbuf is full or we have reached end of the binary
@@ -272,6 +352,9 @@ namespace e57
             break;
          }
 
+         // Read the following packets in the background while we decode this one
+         prefetchPackets( earliestPacketLogicalOffset );
+
          // Feed packet to the hungry decoders
          feedPacketToDecoders( earliestPacketLogicalOffset );
       }
@@ -296,10 +379,71 @@ namespace e57
          }
       }
 
+      adviseAccess();
+
+      nextRecord_ += outputCount;
+
       // Return number of records transferred to each dbuf.
       return outputCount;
    }
 
+   void CompressedVectorReaderImpl::prefetchPackets( uint64_t packetLogicalOffset )
+   {
+      // Packets follow each other, so the next ones are within this range
+      const uint64_t cLength = std::min( cPrefetchPackets * DATA_PACKET_MAX,
+                                         sectionEndLogicalOffset_ - packetLogicalOffset );
+
+      ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
+
+      imf->file_->prefetch( packetLogicalOffset, cLength );
+   }
+
+   void CompressedVectorReaderImpl::adviseAccess()
+   {
+      // Find the earliest data any channel may still need
+      uint64_t neededLogicalOffset = sectionEndLogicalOffset_;
+
+      for ( const auto &channel : channels_ )
+      {
+         if ( !channel.inputFinished )
+         {
+            neededLogicalOffset =
+               std::min( neededLogicalOffset, channel.currentPacketLogicalOffset );
+         }
+      }
+
+      // Only bother the OS once we have moved a full chunk (or reached the end)
+      if ( ( neededLogicalOffset <= releasedLogicalOffset_ ) ||
+           ( neededLogicalOffset - releasedLogicalOffset_ < cAdviseChunkSize &&
+             neededLogicalOffset < sectionEndLogicalOffset_ ) )
+      {
+         return;
+      }
+
+      ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
+
+      // Everything before the earliest needed packet has been decoded, so let the OS drop it...
+      // unless other readers are open on this file, since they may be about to read it.
+      if ( imf->readerCount() == 1 )
+      {
+         imf->file_->adviseAccess( releasedLogicalOffset_,
+                                   neededLogicalOffset - releasedLogicalOffset_,
+                                   CheckedFile::AccessDontNeed );
+      }
+
+      // ... and read ahead the next chunk.
+      const uint64_t cEnd = std::min( neededLogicalOffset + cAdviseChunkSize,
+                                      sectionEndLogicalOffset_ );
+
+      if ( cEnd > neededLogicalOffset )
+      {
+         imf->file_->adviseAccess( neededLogicalOffset, cEnd - neededLogicalOffset,
+                                   CheckedFile::AccessWillNeed );
+      }
+
+      releasedLogicalOffset_ = neededLogicalOffset;
+   }
+
    uint64_t CompressedVectorReaderImpl::earliestPacketNeededForInput() const
    {
       uint64_t earliestPacketLogicalOffset = UINT64_MAX;
@@ -339,13 +483,13 @@ namespace e57
       return earliestPacketLogicalOffset;
    }
 
-   DataPacket *CompressedVectorReaderImpl::dataPacket( uint64_t inLogicalOffset ) const
+   const DataPacket *CompressedVectorReaderImpl::dataPacket( uint64_t inLogicalOffset ) const
    {
-      char *packet = nullptr;
+      const char *packet = nullptr;
 
       std::unique_ptr<PacketLock> packetLock = cache_->lock( inLogicalOffset, packet );
 
-      return reinterpret_cast<DataPacket *>( packet );
+      return reinterpret_cast<const DataPacket *>( packet );
    }
 
    inline bool _alreadyReadPacket( const DecodeChannel &channel,
@@ -371,63 +515,42 @@ namespace e57
       bool anyChannelHasExhaustedPacket = false;
       uint64_t nextPacketLogicalOffset = UINT64_MAX;
 
-      // Feed bytestreams to channels with unblocked output that are reading from this packet
+      // Find the channels with unblocked output that are reading from this packet (skip channels
+      // that have already read it)
+      std::vector<DecodeChannel *> hungryChannels;
+
       for ( DecodeChannel &channel : channels_ )
       {
-         // Skip channels that have already read this packet.
-         if ( _alreadyReadPacket( channel, currentPacketLogicalOffset ) )
+         if ( !_alreadyReadPacket( channel, currentPacketLogicalOffset ) )
          {
-            continue;
+            hungryChannels.push_back( &channel );
          }
+      }
 
-         // Get bytestream buffer for this channel from packet
-         unsigned int bsbLength = 0;
-         const char *bsbStart = dpkt->getBytestream( channel.bytestreamNumber, bsbLength );
-
-         // Double check we are not off end of buffer
-         if ( channel.currentBytestreamBufferIndex > bsbLength )
-         {
-            throw E57_EXCEPTION2(
-               ErrorInternal,
-               "currentBytestreamBufferIndex =" + toString( channel.currentBytestreamBufferIndex ) +
-                  " bsbLength=" + toString( bsbLength ) );
-         }
-
-         // Calc where we are in the buffer
-         const char *uneatenStart = &bsbStart[channel.currentBytestreamBufferIndex];
-         const size_t uneatenLength = bsbLength - channel.currentBytestreamBufferIndex;
-
-         if ( &uneatenStart[uneatenLength] > &bsbStart[bsbLength] )
-         {
-            throw E57_EXCEPTION2( ErrorInternal, "uneatenLength=" + toString( uneatenLength ) +
-                                                    " bsbLength=" + toString( bsbLength ) );
-         }
-
-         // Feed into decoder
-         const size_t bytesProcessed = channel.decoder->inputProcess( uneatenStart, uneatenLength );
-
-#ifdef E57_VERBOSE
-         std::cout << "  stream[" << channel.bytestreamNumber << "]: feeding decoder "
-                   << uneatenLength << " bytes" << std::endl;
-
-         if ( uneatenLength == 0 )
+      // Feed bytestreams to them. Each channel has its own decoder and destination buffer, and
+      // the packet stays in the cache until we ask it for another one, so they can be decoded
+      // in parallel.
+      if ( ( decodePool_ != nullptr ) && ( hungryChannels.size() > 1 ) )
+      {
+         decodePool_->run( hungryChannels.size(), [&]( size_t i ) {
+            feedChannel( *hungryChannels[i], dpkt );
+         } );
+      }
+      else
+      {
+         for ( DecodeChannel *channel : hungryChannels )
          {
-            channel.dump( 8 );
+            feedChannel( *channel, dpkt );
          }
+      }
 
-         std::cout << "  stream[" << channel.bytestreamNumber
-                   << "]: bytesProcessed=" << bytesProcessed << std::endl;
-#endif
-
-         // Adjust counts of bytestream location
-         channel.currentBytestreamBufferIndex += bytesProcessed;
-
-         // Check if this channel has exhausted its bytestream buffer in this
-         // packet
-         if ( channel.isInputBlocked() )
+      // Check if any channel has exhausted its bytestream buffer in this packet
+      for ( const DecodeChannel *channel : hungryChannels )
+      {
+         if ( channel->isInputBlocked() )
          {
 #ifdef E57_VERBOSE
-            std::cout << "  stream[" << channel.bytestreamNumber
+            std::cout << "  stream[" << channel->bytestreamNumber
                       << "] has exhausted its input in current packet" << std::endl;
 #endif
             anyChannelHasExhaustedPacket = true;
@@ -504,6 +627,53 @@ namespace e57
       }
    }
 
+   // Feed the unread part of a channel's bytestream in the packet to its decoder.
+   // This may be called for different channels in parallel.
+   void CompressedVectorReaderImpl::feedChannel( DecodeChannel &channel, const DataPacket *dpkt )
+   {
+      // Get bytestream buffer for this channel from packet
+      unsigned int bsbLength = 0;
+      const char *bsbStart = dpkt->getBytestream( channel.bytestreamNumber, bsbLength );
+
+      // Double check we are not off end of buffer
+      if ( channel.currentBytestreamBufferIndex > bsbLength )
+      {
+         throw E57_EXCEPTION2(
+            ErrorInternal,
+            "currentBytestreamBufferIndex =" + toString( channel.currentBytestreamBufferIndex ) +
+               " bsbLength=" + toString( bsbLength ) );
+      }
+
+      // Calc where we are in the buffer
+      const char *uneatenStart = &bsbStart[channel.currentBytestreamBufferIndex];
+      const size_t uneatenLength = bsbLength - channel.currentBytestreamBufferIndex;
+
+      if ( &uneatenStart[uneatenLength] > &bsbStart[bsbLength] )
+      {
+         throw E57_EXCEPTION2( ErrorInternal, "uneatenLength=" + toString( uneatenLength ) +
+                                                 " bsbLength=" + toString( bsbLength ) );
+      }
+
+      // Feed into decoder
+      const size_t bytesProcessed = channel.decoder->inputProcess( uneatenStart, uneatenLength );
+
+#ifdef E57_VERBOSE
+      std::cout << "  stream[" << channel.bytestreamNumber << "]: feeding decoder " << uneatenLength
+                << " bytes" << std::endl;
+
+      if ( uneatenLength == 0 )
+      {
+         channel.dump( 8 );
+      }
+
+      std::cout << "  stream[" << channel.bytestreamNumber
+                << "]: bytesProcessed=" << bytesProcessed << std::endl;
+#endif
+
+      // Adjust counts of bytestream location
+      channel.currentBytestreamBufferIndex += bytesProcessed;
+   }
+
    uint64_t CompressedVectorReaderImpl::findNextDataPacket( uint64_t nextPacketLogicalOffset )
    {
 #ifdef E57_VERBOSE
@@ -516,7 +686,7 @@ namespace e57
       // hit end of binary section.
       while ( nextPacketLogicalOffset < sectionEndLogicalOffset_ )
       {
-         char *anyPacket = nullptr;
+         const char *anyPacket = nullptr;
 
          std::unique_ptr<PacketLock> packetLock =
             cache_->lock( nextPacketLogicalOffset, anyPacket );
@@ -542,12 +712,406 @@ namespace e57
       return UINT64_MAX;
    }
 
-   void CompressedVectorReaderImpl::seek( uint64_t /*recordNumber*/ )
+   void CompressedVectorReaderImpl::seek( uint64_t recordNumber )
    {
       checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      if ( recordNumber > maxRecordCount_ )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument,
+                               "recordNumber=" + toString( recordNumber ) +
+                                  " maxRecordCount=" + toString( maxRecordCount_ ) +
+                                  " imageFileName=" + cVector_->imageFileName() +
+                                  " cvPathName=" + cVector_->pathName() );
+      }
+
+      nextRecord_ = recordNumber;
+
+      // Seeking to the end leaves nothing to read
+      if ( recordNumber == maxRecordCount_ )
+      {
+         for ( auto &channel : channels_ )
+         {
+            channel.decoder->seekRecord( recordNumber, 0 );
+            channel.inputFinished = true;
+         }
+
+         return;
+      }
+
+      // Each bytestream starts afresh at the beginning of a chunk, so start from the closest one
+      uint64_t chunkRecordNumber = 0;
+      const uint64_t cChunkLogicalOffset = findChunk( recordNumber, chunkRecordNumber );
+
+      if ( cChunkLogicalOffset != packetMapChunkLogicalOffset_ )
+      {
+         if ( dataPacket( cChunkLogicalOffset )->header.packetType != DATA_PACKET )
+         {
+            throw E57_EXCEPTION2( ErrorBadCVPacket,
+                                  "chunkLogicalOffset=" + toString( cChunkLogicalOffset ) +
+                                     " recordNumber=" + toString( recordNumber ) );
+         }
+
+         packetMap_.clear();
+         packetMapChunkLogicalOffset_ = cChunkLogicalOffset;
+         packetMapNextLogicalOffset_ = cChunkLogicalOffset;
+      }
+
+      for ( size_t i = 0; i < channels_.size(); i++ )
+      {
+         DecodeChannel &channel = channels_[i];
+
+         // Find where the record is in this channel's bytestream. If that can't be calculated,
+         // start at the beginning of the chunk and decode our way to the record.
+         uint64_t byteOffset = 0;
+         size_t firstBit = 0;
+
+         const bool cKnownPosition = channel.decoder->recordPosition(
+            recordNumber - chunkRecordNumber, byteOffset, firstBit );
+
+         if ( !cKnownPosition )
+         {
+            byteOffset = 0;
+            firstBit = 0;
+         }
+
+         // Find the data packet holding that byte, scanning more packets if we need to
+         const auto cEndsBefore = [i]( const PacketPosition &position, uint64_t offset ) {
+            return position.bytestreamEnds[i] < offset;
+         };
+
+         size_t position = static_cast<size_t>(
+            std::lower_bound( packetMap_.begin(), packetMap_.end(), byteOffset, cEndsBefore ) -
+            packetMap_.begin() );
+
+         while ( position == packetMap_.size() )
+         {
+            if ( !scanNextDataPacket() )
+            {
+               throw E57_EXCEPTION2( ErrorBadCVPacket,
+                                     "recordNumber=" + toString( recordNumber ) +
+                                        " byteOffset=" + toString( byteOffset ) +
+                                        " bytestreamNumber=" +
+                                        toString( channel.bytestreamNumber ) );
+            }
+
+            if ( packetMap_.back().bytestreamEnds[i] >= byteOffset )
+            {
+               position = packetMap_.size() - 1;
+            }
+            else
+            {
+               position = packetMap_.size();
+            }
+         }
 
-      // !!! implement
-      throw E57_EXCEPTION1( ErrorNotImplemented );
+         const uint64_t cPacketStart =
+            ( position == 0 ) ? 0 : packetMap_[position - 1].bytestreamEnds[i];
+
+         channel.currentPacketLogicalOffset = packetMap_[position].logicalOffset;
+         channel.currentBytestreamBufferIndex = static_cast<size_t>( byteOffset - cPacketStart );
+         channel.currentBytestreamBufferLength =
+            static_cast<size_t>( packetMap_[position].bytestreamEnds[i] - cPacketStart );
+         channel.inputFinished = false;
+
+         if ( cKnownPosition )
+         {
+            channel.decoder->seekRecord( recordNumber, firstBit );
+         }
+         else
+         {
+            channel.decoder->seekRecord( chunkRecordNumber, 0 );
+
+            skipRecords( channel, recordNumber );
+         }
+      }
+
+      // Start reading ahead from the new position
+      uint64_t neededLogicalOffset = sectionEndLogicalOffset_;
+
+      for ( const auto &channel : channels_ )
+      {
+         neededLogicalOffset = std::min( neededLogicalOffset, channel.currentPacketLogicalOffset );
+      }
+
+      ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
+
+      imf->file_->adviseAccess(
+         neededLogicalOffset,
+         std::min( sectionEndLogicalOffset_ - neededLogicalOffset, cAdviseChunkSize ),
+         CheckedFile::AccessWillNeed );
+
+      releasedLogicalOffset_ = neededLogicalOffset;
+   }
+
+   uint64_t CompressedVectorReaderImpl::findChunk( uint64_t recordNumber,
+                                                   uint64_t &chunkRecordNumber )
+   {
+      chunkRecordNumber = 0;
+
+      // Without an index, the only chunk we know of starts at the first data packet
+      if ( indexLogicalOffset_ == 0 )
+      {
+         return dataLogicalOffset_;
+      }
+
+      ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
+
+      uint64_t packetLogicalOffset = indexLogicalOffset_;
+      unsigned previousLevel = UINT_MAX;
+
+      // Walk down the index tree to the last chunk starting at or before the record
+      while ( true )
+      {
+         const char *anyPacket = nullptr;
+
+         std::unique_ptr<PacketLock> packetLock = cache_->lock( packetLogicalOffset, anyPacket );
+
+         auto ipkt = reinterpret_cast<const IndexPacket *>( anyPacket );
+
+         // Each level has to be below the one which points to it
+         if ( ( ipkt->header.packetType != INDEX_PACKET ) ||
+              ( ipkt->header.indexLevel >= previousLevel ) )
+         {
+            throw E57_EXCEPTION2( ErrorBadCVPacket,
+                                  "packetType=" + toString( ipkt->header.packetType ) +
+                                     " indexLevel=" + toString( ipkt->header.indexLevel ) +
+                                     " packetLogicalOffset=" + toString( packetLogicalOffset ) );
+         }
+
+         const auto cEntriesEnd = &ipkt->entries[ipkt->header.entryCount];
+
+         auto entry = std::upper_bound(
+            &ipkt->entries[0], cEntriesEnd, recordNumber,
+            []( uint64_t record, const IndexPacket::Entry &e ) {
+               return record < e.chunkRecordNumber;
+            } );
+
+         if ( entry == &ipkt->entries[0] )
+         {
+            throw E57_EXCEPTION2( ErrorBadCVPacket,
+                                  "chunkRecordNumber=" + toString( entry->chunkRecordNumber ) +
+                                     " recordNumber=" + toString( recordNumber ) );
+         }
+
+         --entry;
+
+         chunkRecordNumber = entry->chunkRecordNumber;
+         packetLogicalOffset = imf->file_->physicalToLogical( entry->chunkPhysicalOffset );
+
+         // Level 0 entries point at data packets
+         if ( ipkt->header.indexLevel == 0 )
+         {
+            return packetLogicalOffset;
+         }
+
+         previousLevel = ipkt->header.indexLevel;
+      }
+   }
+
+   bool CompressedVectorReaderImpl::scanNextDataPacket()
+   {
+      ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
+
+      // Only the headers are read, not the whole packets
+      while ( packetMapNextLogicalOffset_ < sectionEndLogicalOffset_ )
+      {
+         const uint64_t cLogicalOffset = packetMapNextLogicalOffset_;
+
+         alignas( DataPacketHeader ) char headerBytes[sizeof( DataPacketHeader )];
+
+         imf->file_->readAt( cLogicalOffset, headerBytes, sizeof( headerBytes ) );
+
+         auto header = reinterpret_cast<const DataPacketHeader *>( headerBytes );
+
+         packetMapNextLogicalOffset_ += header->packetLogicalLengthMinus1 + 1;
+
+         // Skip over index and empty packets
+         if ( header->packetType != DATA_PACKET )
+         {
+            continue;
+         }
+
+         header->verify();
+
+         // The bytestream buffer lengths follow the header
+         std::vector<uint16_t> lengths( header->bytestreamCount );
+
+         if ( !lengths.empty() )
+         {
+            imf->file_->readAt( cLogicalOffset + sizeof( DataPacketHeader ),
+                                reinterpret_cast<char *>( lengths.data() ),
+                                lengths.size() * sizeof( uint16_t ) );
+         }
+
+         PacketPosition position{ cLogicalOffset, {} };
+
+         position.bytestreamEnds.reserve( channels_.size() );
+
+         for ( size_t i = 0; i < channels_.size(); i++ )
+         {
+            const unsigned cBytestreamNumber = channels_[i].bytestreamNumber;
+
+            if ( cBytestreamNumber >= lengths.size() )
+            {
+               throw E57_EXCEPTION2( ErrorBadCVPacket,
+                                     "bytestreamNumber=" + toString( cBytestreamNumber ) +
+                                        " bytestreamCount=" + toString( lengths.size() ) );
+            }
+
+            const uint64_t cStart = packetMap_.empty() ? 0 : packetMap_.back().bytestreamEnds[i];
+
+            position.bytestreamEnds.push_back( cStart + lengths[cBytestreamNumber] );
+         }
+
+         packetMap_.push_back( std::move( position ) );
+
+         return true;
+      }
+
+      return false;
+   }
+
+   void CompressedVectorReaderImpl::skipRecords( DecodeChannel &channel, uint64_t recordNumber )
+   {
+      // Number of records decoded (and thrown away) at a time
+      constexpr uint64_t cSkipBufferCount = 1024;
+
+      // Decode into our own buffer, then give the channel back the user's one
+      SourceDestBuffer userDbuf = channel.dbuf;
+      std::vector<SourceDestBuffer> userDbufs{ userDbuf };
+
+      std::vector<ustring> skipped;
+
+      try
+      {
+         while ( channel.decoder->totalRecordsCompleted() < recordNumber )
+         {
+            skipped.resize( static_cast<size_t>( std::min(
+               cSkipBufferCount, recordNumber - channel.decoder->totalRecordsCompleted() ) ) );
+
+            std::vector<SourceDestBuffer> skipDbufs{ SourceDestBuffer(
+               Node( proto_ ).destImageFile(), userDbuf.pathName(), &skipped ) };
+
+            channel.dbuf = skipDbufs.at( 0 );
+            channel.decoder->destBufferSetNew( skipDbufs );
+
+            channel.decoder->inputProcess( nullptr, 0 );
+
+            while ( !channel.isOutputBlocked() )
+            {
+               if ( channel.inputFinished )
+               {
+                  throw E57_EXCEPTION2( ErrorBadCVPacket,
+                                        "recordNumber=" + toString( recordNumber ) +
+                                           " bytestreamNumber=" +
+                                           toString( channel.bytestreamNumber ) );
+               }
+
+               if ( channel.isInputBlocked() )
+               {
+                  // Move on to this bytestream's buffer in the next data packet
+                  const DataPacket *dpkt = dataPacket( channel.currentPacketLogicalOffset );
+
+                  const uint64_t cNextLogicalOffset =
+                     findNextDataPacket( channel.currentPacketLogicalOffset +
+                                         dpkt->header.packetLogicalLengthMinus1 + 1 );
+
+                  if ( cNextLogicalOffset == UINT64_MAX )
+                  {
+                     channel.inputFinished = true;
+                     continue;
+                  }
+
+                  channel.currentPacketLogicalOffset = cNextLogicalOffset;
+                  channel.currentBytestreamBufferIndex = 0;
+                  channel.currentBytestreamBufferLength =
+                     dataPacket( cNextLogicalOffset )
+                        ->getBytestreamBufferLength( channel.bytestreamNumber );
+                  continue;
+               }
+
+               unsigned int bsbLength = 0;
+               const char *bsbStart =
+                  dataPacket( channel.currentPacketLogicalOffset )
+                     ->getBytestream( channel.bytestreamNumber, bsbLength );
+
+               channel.currentBytestreamBufferIndex += channel.decoder->inputProcess(
+                  &bsbStart[channel.currentBytestreamBufferIndex],
+                  bsbLength - channel.currentBytestreamBufferIndex );
+            }
+         }
+      }
+      catch ( ... )
+      {
+         channel.dbuf = userDbuf;
+         channel.decoder->destBufferSetNew( userDbufs );
+         throw;
+      }
+
+      channel.dbuf = userDbuf;
+      channel.decoder->destBufferSetNew( userDbufs );
+   }
+
+   void CompressedVectorReaderImpl::setPacketCacheSize( unsigned packetCount )
+   {
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      if ( packetCount == 0 )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument, "packetCount=" + toString( packetCount ) +
+                                                       " imageFileName=" +
+                                                       cVector_->imageFileName() +
+                                                       " cvPathName=" + cVector_->pathName() );
+      }
+
+      cache_->resize( packetCount );
+   }
+
+   unsigned CompressedVectorReaderImpl::packetCacheSize() const
+   {
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      return cache_->size();
+   }
+
+   void CompressedVectorReaderImpl::setDecodeThreadCount( unsigned threadCount )
+   {
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      if ( threadCount == 0 )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument, "threadCount=" + toString( threadCount ) +
+                                                       " imageFileName=" +
+                                                       cVector_->imageFileName() +
+                                                       " cvPathName=" + cVector_->pathName() );
+      }
+
+      if ( threadCount == decodeThreadCount() )
+      {
+         return;
+      }
+
+      delete decodePool_;
+      decodePool_ = nullptr;
+
+      // With one thread, everything is decoded on the caller's thread as before
+      if ( threadCount > 1 )
+      {
+         decodePool_ = new ThreadPool( threadCount );
+      }
+   }
+
+   unsigned CompressedVectorReaderImpl::decodeThreadCount() const
+   {
+      checkImageFileOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+      checkReaderOpen( __FILE__, __LINE__, static_cast<const char *>( __FUNCTION__ ) );
+
+      return ( decodePool_ != nullptr ) ? decodePool_->threadCount() : 1;
    }
 
    bool CompressedVectorReaderImpl::isOpen() const
@@ -583,6 +1147,9 @@ namespace e57
       delete cache_;
       cache_ = nullptr;
 
+      delete decodePool_;
+      decodePool_ = nullptr;
+
       isOpen_ = false;
    }
 
@@ -631,6 +1198,7 @@ namespace e57
       }
 
       os << space( indent ) << "recordCount:             " << recordCount_ << std::endl;
+      os << space( indent ) << "nextRecord:              " << nextRecord_ << std::endl;
       os << space( indent ) << "maxRecordCount:          " << maxRecordCount_ << std::endl;
       os << space( indent ) << "sectionEndLogicalOffset: " << sectionEndLogicalOffset_ << std::endl;
    }
@@ -32,6 +32,7 @@ namespace e57
 {
    class DataPacket;
    class PacketReadCache;
+   class ThreadPool;
 
    class CompressedVectorReaderImpl
    {
@@ -42,7 +43,12 @@ namespace e57
 
       unsigned read();
       unsigned read( std::vector<SourceDestBuffer> &dbufs );
+      unsigned read( uint64_t startRecord, size_t count );
       void seek( uint64_t recordNumber );
+      void setPacketCacheSize( unsigned packetCount );
+      unsigned packetCacheSize() const;
+      void setDecodeThreadCount( unsigned threadCount );
+      unsigned decodeThreadCount() const;
       bool isOpen() const;
       std::shared_ptr<CompressedVectorNodeImpl> compressedVectorNode() const;
       void close();
@@ -57,11 +63,27 @@ namespace e57
       void checkReaderOpen( const char *srcFileName, int srcLineNumber,
                             const char *srcFunctionName ) const;
       void setBuffers( std::vector<SourceDestBuffer> &dbufs ); //???needed?
+      unsigned decodeRecords();
       uint64_t earliestPacketNeededForInput() const;
 
-      DataPacket *dataPacket( uint64_t inLogicalOffset ) const;
+      const DataPacket *dataPacket( uint64_t inLogicalOffset ) const;
       void feedPacketToDecoders( uint64_t currentPacketLogicalOffset );
+      void feedChannel( DecodeChannel &channel, const DataPacket *dpkt );
       uint64_t findNextDataPacket( uint64_t nextPacketLogicalOffset );
+      void prefetchPackets( uint64_t packetLogicalOffset );
+      void adviseAccess();
+
+      uint64_t findChunk( uint64_t recordNumber, uint64_t &chunkRecordNumber );
+      bool scanNextDataPacket();
+      void skipRecords( DecodeChannel &channel, uint64_t recordNumber );
+
+      /// A data packet, and how far each channel's bytestream has got by its end (in bytes from
+      /// the start of the chunk)
+      struct PacketPosition
+      {
+         uint64_t logicalOffset;
+         std::vector<uint64_t> bytestreamEnds;
+      };
 
       //??? no default ctor, copy, assignment?
 
@@ -71,9 +93,19 @@ namespace e57
       NodeImplSharedPtr proto_;
       std::vector<DecodeChannel> channels_;
       PacketReadCache *cache_;
+      ThreadPool *decodePool_; /// decodes the channels in parallel, nullptr if not used
 
       uint64_t recordCount_; /// number of records written so far
       uint64_t maxRecordCount_;
+      uint64_t nextRecord_; /// record the next read starts at
       uint64_t sectionEndLogicalOffset_;
+      uint64_t releasedLogicalOffset_; /// data before this has been released to the OS
+      uint64_t dataLogicalOffset_;     /// first data packet
+      uint64_t indexLogicalOffset_;    /// top level index packet, 0 if there isn't one
+
+      // Data packets scanned by seek(), from the start of a chunk. Built as far as needed.
+      std::vector<PacketPosition> packetMap_;
+      uint64_t packetMapChunkLogicalOffset_; /// first data packet of the chunk packetMap_ is from
+      uint64_t packetMapNextLogicalOffset_;  /// next packet to scan
    };
 }
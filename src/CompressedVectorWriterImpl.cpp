@@ -25,6 +25,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 
@@ -38,6 +39,13 @@
 
 namespace e57
 {
+   /// Number of data packets after which the writer starts a new chunk (indexed for seeking)
+   constexpr uint64_t cChunkPacketCount = 8;
+
+   /// Chunks start on a multiple of this many records, so every bytestream starts on a whole
+   /// 64-bit word and continues from the previous chunk without any padding
+   constexpr uint64_t cChunkRecordAlignment = 64;
+
    struct SortByBytestreamNumber
    {
       bool operator()( const std::shared_ptr<Encoder> &lhs,
@@ -123,6 +131,11 @@ namespace e57
       dataPacketsCount_ = 0;
       indexPacketsCount_ = 0;
 
+      // The first data packet starts the first chunk
+      chunkStartRecord_ = 0;
+      chunkEndRecord_ = UINT64_MAX;
+      chunkPacketsCount_ = 0;
+
       // Just before return (and can't throw) increment writer count  ??? safer
       // way to assure don't miss close?
       imf->incrWriterCount();
@@ -183,7 +196,7 @@ namespace e57
          flush();
       }
 
-      // Write one index packet (required by standard).
+      // Write the index packets (at least one is required by standard).
       packetWriteIndex();
 
       // Compute length of whole section we just wrote (from section start to
@@ -210,8 +223,8 @@ namespace e57
 #endif
 
       // Write header at beginning of section, previously allocated
-      imf->file_->seek( sectionHeaderLogicalStart_ );
-      imf->file_->write( reinterpret_cast<char *>( &header ), sizeof( header ) );
+      imf->file_->writeAt( sectionHeaderLogicalStart_, reinterpret_cast<char *>( &header ),
+                           sizeof( header ) );
 
       // Set address and size of associated CompressedVector
       cVector_->setRecordCount( recordCount_ );
@@ -316,6 +329,13 @@ namespace e57
       uint64_t endRecordIndex = recordCount_ + requestedRecordCount;
       while ( true )
       {
+         // Once every bytestream has got to the end of the chunk, write them out and start the
+         // next one
+         if ( chunkEndReached() )
+         {
+            startChunk();
+         }
+
          // Calc remaining record counts for all channels
          uint64_t totalRecordCount = 0;
          for ( auto &bytestream : bytestreams_ )
@@ -355,6 +375,23 @@ namespace e57
          if ( currentPacketSize() >= E57_TARGET_PACKET_SIZE )
          { //???
             packetWrite();
+
+            // After enough packets, end this chunk at the next aligned record none of the
+            // bytestreams has got to yet
+            if ( chunkPacketsCount_ >= cChunkPacketCount && chunkEndRecord_ == UINT64_MAX )
+            {
+               uint64_t furthestRecordIndex = 0;
+
+               for ( auto &bytestream : bytestreams_ )
+               {
+                  furthestRecordIndex =
+                     std::max( furthestRecordIndex, bytestream->currentRecordIndex() );
+               }
+
+               chunkEndRecord_ = ( furthestRecordIndex + cChunkRecordAlignment - 1 ) /
+                                 cChunkRecordAlignment * cChunkRecordAlignment;
+            }
+
             continue; // restart loop so recalc statistics (packet size may not be
                       // zero after write, if have too much data)
          }
@@ -378,14 +415,17 @@ namespace e57
          // Don't allow a single channel to get too far ahead ???
          // Process channels that are furthest behind first. ???
 
+         // Don't go past the end of the chunk
+         const uint64_t cEndRecordIndex = std::min( endRecordIndex, chunkEndRecord_ );
+
          // !!!! For now just process one record per loop until packet is full
          // enough, or completed request
          for ( auto &bytestream : bytestreams_ )
          {
-            if ( bytestream->currentRecordIndex() < endRecordIndex )
+            if ( bytestream->currentRecordIndex() < cEndRecordIndex )
             {
                // !!! For now, process up to 50 records at a time
-               uint64_t recordCount = endRecordIndex - bytestream->currentRecordIndex();
+               uint64_t recordCount = cEndRecordIndex - bytestream->currentRecordIndex();
                recordCount =
                   ( recordCount < 50ULL ) ? recordCount : 50ULL; // min(recordCount, 50ULL);
                bytestream->processRecords( static_cast<unsigned>( recordCount ) );
@@ -418,6 +458,39 @@ namespace e57
                totalOutputAvailable() );
    }
 
+   bool CompressedVectorWriterImpl::chunkEndReached() const
+   {
+      if ( chunkEndRecord_ == UINT64_MAX )
+      {
+         return false;
+      }
+
+      for ( const auto &bytestream : bytestreams_ )
+      {
+         if ( bytestream->currentRecordIndex() != chunkEndRecord_ )
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   void CompressedVectorWriterImpl::startChunk()
+   {
+      // Every bytestream ends on a whole word, so there is nothing left in the encoder registers.
+      // Write out everything up to the end of the chunk so the next packet starts the new one
+      // with each bytestream at its first record.
+      while ( totalOutputAvailable() > 0 )
+      {
+         packetWrite();
+      }
+
+      chunkStartRecord_ = chunkEndRecord_;
+      chunkEndRecord_ = UINT64_MAX;
+      chunkPacketsCount_ = 0;
+   }
+
    uint64_t CompressedVectorWriterImpl::packetWrite()
    {
 #ifdef E57_VERBOSE
@@ -589,9 +662,7 @@ namespace e57
       // Write whole data packet at beginning of free space in file
       uint64_t packetLogicalOffset = imf->allocateSpace( packetLength, false );
       uint64_t packetPhysicalOffset = imf->file_->logicalToPhysical( packetLogicalOffset );
-      imf->file_->seek( packetLogicalOffset ); //??? have seekLogical and seekPhysical instead?
-                                               // more explicit
-      imf->file_->write( packet, packetLength );
+      imf->file_->writeAt( packetLogicalOffset, packet, packetLength );
 
 #ifdef E57_VERBOSE
 //  std::cout << "data packet:" << std::endl;
@@ -610,7 +681,19 @@ namespace e57
       }
       dataPacketsCount_++;
 
-      // !!! update seekIndex here? if started new chunk?
+      // If this packet starts a chunk, add it to the index
+      if ( chunkStartRecord_ != UINT64_MAX )
+      {
+         IndexPacket::Entry entry;
+         entry.chunkRecordNumber = chunkStartRecord_;
+         entry.chunkPhysicalOffset = packetPhysicalOffset;
+
+         chunkIndex_.push_back( entry );
+
+         chunkStartRecord_ = UINT64_MAX;
+      }
+
+      chunkPacketsCount_++;
 
       // Return physical offset of data packet for potential use in seekIndex
       return ( packetPhysicalOffset ); //??? needed
@@ -648,8 +731,7 @@ namespace e57
       uint64_t packetLogicalOffset = imf->allocateSpace( packetLength, false );
       uint64_t packetPhysicalOffset = imf->file_->logicalToPhysical( packetLogicalOffset );
 
-      imf->file_->seek( packetLogicalOffset );
-      imf->file_->write( packet, packetLength );
+      imf->file_->writeAt( packetLogicalOffset, packet, packetLength );
 
       // If first data packet written for this CompressedVector binary section,
       // save address to put in section header
@@ -661,29 +743,80 @@ namespace e57
       dataPacketsCount_++;
    }
 
-   // Write one index packet.
-   // We don't have an interface to work with index packets, but one is required by the standard, so
-   // write one index packet with one entry pointing to the first data packet.
+   // Write the index packets: a tree with one entry per chunk in level 0, and one entry per index
+   // packet of the level below in the levels above it, up to a single top level packet.
    void e57::CompressedVectorWriterImpl::packetWriteIndex()
    {
       ImageFileImplSharedPtr imf( cVector_->destImageFile_ );
 
-      IndexPacket indexPacket;
+      std::vector<IndexPacket::Entry> entries = chunkIndex_;
+
+      // If there are no records, point at the (empty) data packet
+      if ( entries.empty() )
+      {
+         IndexPacket::Entry entry;
+         entry.chunkPhysicalOffset = dataPhysicalOffset_;
+
+         entries.push_back( entry );
+      }
+
+      uint8_t indexLevel = 0;
+
+      while ( true )
+      {
+         std::vector<IndexPacket::Entry> parentEntries;
+
+         for ( size_t first = 0; first < entries.size(); )
+         {
+            const size_t cRemaining = entries.size() - first;
+            size_t entryCount = std::min<size_t>( IndexPacket::MAX_ENTRIES, cRemaining );
+
+            // Packets above level 0 need at least 2 entries, so don't leave just one for the last
+            // packet of the level: move one over from this packet instead.
+            if ( cRemaining == IndexPacket::MAX_ENTRIES + 1 )
+            {
+               entryCount--;
+            }
+
+            IndexPacket indexPacket;
+
+            std::copy( entries.begin() + first, entries.begin() + first + entryCount,
+                       indexPacket.entries );
+
+            const auto cPacketLength =
+               sizeof( IndexPacketHeader ) + entryCount * sizeof( IndexPacket::Entry );
 
-      indexPacket.entries[0].chunkPhysicalOffset = dataPhysicalOffset_;
+            indexPacket.header.packetLogicalLengthMinus1 =
+               static_cast<uint16_t>( cPacketLength - 1 );
+            indexPacket.header.entryCount = static_cast<uint16_t>( entryCount );
+            indexPacket.header.indexLevel = indexLevel;
 
-      const auto cPacketLength = sizeof( IndexPacketHeader ) + sizeof( IndexPacket::Entry );
+            uint64_t packetLogicalOffset = imf->allocateSpace( cPacketLength, false );
 
-      indexPacket.header.packetLogicalLengthMinus1 = cPacketLength - 1;
-      indexPacket.header.entryCount = 1;
+            imf->file_->writeAt( packetLogicalOffset,
+                                 reinterpret_cast<const char *>( &indexPacket ), cPacketLength );
 
-      uint64_t packetLogicalOffset = imf->allocateSpace( cPacketLength, false );
-      topIndexPhysicalOffset_ = imf->file_->logicalToPhysical( packetLogicalOffset );
+            indexPacketsCount_++;
 
-      imf->file_->seek( packetLogicalOffset );
-      imf->file_->write( reinterpret_cast<const char *>( &indexPacket ), cPacketLength );
+            // The level above points at this packet
+            IndexPacket::Entry parentEntry;
+            parentEntry.chunkRecordNumber = entries[first].chunkRecordNumber;
+            parentEntry.chunkPhysicalOffset = imf->file_->logicalToPhysical( packetLogicalOffset );
 
-      indexPacketsCount_++;
+            parentEntries.push_back( parentEntry );
+
+            first += entryCount;
+         }
+
+         if ( parentEntries.size() == 1 )
+         {
+            topIndexPhysicalOffset_ = parentEntries.front().chunkPhysicalOffset;
+            return;
+         }
+
+         entries = std::move( parentEntries );
+         indexLevel++;
+      }
    }
 
    void CompressedVectorWriterImpl::flush()
@@ -759,6 +892,7 @@ namespace e57
       os << space( indent ) << "recordCount:               " << recordCount_ << std::endl;
       os << space( indent ) << "dataPacketsCount:          " << dataPacketsCount_ << std::endl;
       os << space( indent ) << "indexPacketsCount:         " << indexPacketsCount_ << std::endl;
+      os << space( indent ) << "chunkCount:                " << chunkIndex_.size() << std::endl;
    }
 #endif
 }
@@ -59,6 +59,8 @@ namespace e57
       uint64_t packetWrite();
       void packetWriteZeroRecords();
       void packetWriteIndex();
+      bool chunkEndReached() const;
+      void startChunk();
 
       void flush();
 
@@ -77,5 +79,10 @@ namespace e57
       uint64_t recordCount_;               /// number of records written so far
       uint64_t dataPacketsCount_;          /// number of data packets written so far
       uint64_t indexPacketsCount_;         /// number of index packets written so far
+
+      std::vector<IndexPacket::Entry> chunkIndex_; /// first record and data packet of each chunk
+      uint64_t chunkStartRecord_;  /// chunk started by the next data packet (UINT64_MAX if none)
+      uint64_t chunkEndRecord_;    /// record starting the next chunk (UINT64_MAX if not decided)
+      uint64_t chunkPacketsCount_; /// number of data packets written in the current chunk
    };
 }
@@ -51,7 +51,7 @@ namespace e57
       }
 
       // If we have filled the dest buffer, we are blocked
-      return ( dbuf.impl()->nextIndex() == dbuf.impl()->capacity() );
+      return ( dbuf.impl()->nextIndex() >= dbuf.impl()->limit() );
    }
 
    bool DecodeChannel::isInputBlocked() const
@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <cstring>
 
+#include "BitUnpack.h"
 #include "CompressedVectorNodeImpl.h"
 #include "Decoder.h"
 #include "FloatNodeImpl.h"
@@ -272,9 +273,15 @@ size_t BitpackDecoder::inputProcess( const char *source, const size_t availableB
       std::cout << "  feeding aligned decoder " << endBit - inBufferFirstBit_ << " bits."
                 << std::endl;
 #endif
-      bitsEaten =
-         inputProcessAligned( &inBuffer_[firstWord * bytesPerWord_],
-                              inBufferFirstBit_ - firstNaturalBit, endBit - firstNaturalBit );
+      // After a seek, the first bit may be in a word we haven't been given yet
+      bitsEaten = 0;
+
+      if ( endBit >= inBufferFirstBit_ )
+      {
+         bitsEaten =
+            inputProcessAligned( &inBuffer_[firstWord * bytesPerWord_],
+                                 inBufferFirstBit_ - firstNaturalBit, endBit - firstNaturalBit );
+      }
 #ifdef E57_VERBOSE
       std::cout << "  bitsEaten=" << bitsEaten << " firstWord=" << firstWord
                 << " firstNaturalBit=" << firstNaturalBit << " endBit=" << endBit << std::endl;
@@ -308,6 +315,25 @@ void BitpackDecoder::stateReset()
    inBufferEndByte_ = 0;
 }
 
+void BitpackDecoder::seekRecord( uint64_t recordNumber, size_t firstBit )
+{
+   // Drop any input we have. The next input starts at the word containing firstBit.
+   inBufferFirstBit_ = firstBit;
+   inBufferEndByte_ = 0;
+
+   currentRecordIndex_ = recordNumber;
+}
+
+void BitpackDecoder::alignedPosition( uint64_t bitOffset, uint64_t &byteOffset,
+                                      size_t &firstBit ) const
+{
+   // Input has to be fed starting on a natural word boundary
+   const uint64_t cWord = bitOffset / bitsPerWord_;
+
+   byteOffset = cWord * bytesPerWord_;
+   firstBit = static_cast<size_t>( bitOffset - cWord * bitsPerWord_ );
+}
+
 void BitpackDecoder::inBufferShiftDown()
 {
    // Move uneaten data down to beginning of inBuffer_.
@@ -365,6 +391,37 @@ void BitpackDecoder::dump( int indent, std::ostream &os )
 
 //================================================================
 
+namespace
+{
+   void setNextRealBlock( SourceDestBufferImpl &dest, const float *values, size_t count )
+   {
+      dest.setNextFloatBlock( values, count );
+   }
+
+   void setNextRealBlock( SourceDestBufferImpl &dest, const double *values, size_t count )
+   {
+      dest.setNextDoubleBlock( values, count );
+   }
+
+   // Store count values of type T from a packet in a dest buffer of another type. The values are
+   // copied into an (aligned) array first, a block at a time.
+   template <typename T>
+   void storeRealsConverted( SourceDestBufferImpl &dest, const char *inbuf, size_t count )
+   {
+      constexpr size_t cBlockRecords = 256;
+      T values[cBlockRecords];
+
+      for ( size_t done = 0; done < count; done += cBlockRecords )
+      {
+         const size_t cCount = std::min( cBlockRecords, count - done );
+
+         memcpy( values, inbuf + done * sizeof( T ), cCount * sizeof( T ) );
+
+         setNextRealBlock( dest, values, cCount );
+      }
+   }
+}
+
 BitpackFloatDecoder::BitpackFloatDecoder( unsigned bytestreamNumber, SourceDestBuffer &dbuf,
                                           FloatPrecision precision, uint64_t maxRecordCount ) :
    BitpackDecoder( bytestreamNumber, dbuf,
@@ -385,7 +442,7 @@ size_t BitpackFloatDecoder::inputProcessAligned( const char *inbuf, const size_t
    // Read from inbuf, decode, store in destBuffer
    // Repeat until have filled destBuffer, or completed all records
 
-   size_t n = destBuffer_->capacity() - destBuffer_->nextIndex();
+   size_t n = destBuffer_->limit() - destBuffer_->nextIndex();
 
    size_t typeSize = ( precision_ == PrecisionSingle ) ? sizeof( float ) : sizeof( double );
 
@@ -425,40 +482,28 @@ size_t BitpackFloatDecoder::inputProcessAligned( const char *inbuf, const size_t
    std::cout << "  n:" << n << std::endl; //???
 #endif
 
-   if ( precision_ == PrecisionSingle )
-   {
-      // Form the starting address for first data location in inBuffer
-      auto inp = reinterpret_cast<const float *>( inbuf );
+   // Values in the file are in the same (little-endian IEEE) layout as in memory, so if the dest
+   // buffer holds the same type they can be copied as a block. Otherwise they are converted a
+   // block at a time. Either way inbuf is only read with memcpy, so its alignment doesn't matter.
+   const MemoryRepresentation cNativeRepresentation =
+      ( precision_ == PrecisionSingle ) ? Real32 : Real64;
 
-      // Copy floats from inbuf to destBuffer_
-      for ( unsigned i = 0; i < n; i++ )
-      {
-         float value = *inp;
-
-#ifdef E57_VERBOSE
-         std::cout << "  got float value=" << value << std::endl;
-#endif
-         destBuffer_->setNextFloat( value );
-         inp++;
-      }
+   if ( destBuffer_->memoryRepresentation() == cNativeRepresentation )
+   {
+      destBuffer_->copyNextReals( inbuf, n );
+   }
+   else if ( precision_ == PrecisionSingle )
+   {
+      storeRealsConverted<float>( *destBuffer_, inbuf, n );
    }
    else
    { // Double precision
-      // Form the starting address for first data location in inBuffer
-      auto inp = reinterpret_cast<const double *>( inbuf );
-
-      // Copy doubles from inbuf to destBuffer_
-      for ( unsigned i = 0; i < n; i++ )
-      {
-         double value = *inp;
+      storeRealsConverted<double>( *destBuffer_, inbuf, n );
+   }
 
 #ifdef E57_VERBOSE
-         std::cout << "  got double value=" << value << std::endl;
+   std::cout << "  stored " << n << " values" << std::endl;
 #endif
-         destBuffer_->setNextDouble( value );
-         inp++;
-      }
-   }
 
    // Update counts of records processed
    currentRecordIndex_ += n;
@@ -467,6 +512,15 @@ size_t BitpackFloatDecoder::inputProcessAligned( const char *inbuf, const size_t
    return ( n * 8 * typeSize );
 }
 
+bool BitpackFloatDecoder::recordPosition( uint64_t recordNumber, uint64_t &byteOffset,
+                                          size_t &firstBit ) const
+{
+   // Each record is one word
+   alignedPosition( recordNumber * bitsPerWord_, byteOffset, firstBit );
+
+   return true;
+}
+
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
 void BitpackFloatDecoder::dump( int indent, std::ostream &os )
 {
@@ -512,9 +566,10 @@ size_t BitpackStringDecoder::inputProcessAligned( const char *inbuf, const size_
    size_t nBytesAvailable = ( endBit - firstBit ) >> 3;
    size_t nBytesRead = 0;
 
-   // Loop until we've finished all the records, or ran out of input currently
-   // available
-   while ( currentRecordIndex_ < maxRecordCount_ && nBytesRead < nBytesAvailable )
+   // Loop until we've finished all the records, filled destBuffer, or ran out of input
+   // currently available
+   while ( currentRecordIndex_ < maxRecordCount_ && nBytesRead < nBytesAvailable &&
+           destBuffer_->nextIndex() < destBuffer_->limit() )
    {
 #ifdef E57_VERBOSE
       std::cout << "read string loop1: readingPrefix=" << readingPrefix_
@@ -635,6 +690,28 @@ size_t BitpackStringDecoder::inputProcessAligned( const char *inbuf, const size_
    return ( nBytesRead * 8 );
 }
 
+bool BitpackStringDecoder::recordPosition( uint64_t recordNumber, uint64_t &byteOffset,
+                                           size_t &firstBit ) const
+{
+   // Strings vary in length, so we can only find the position of the first one
+   byteOffset = 0;
+   firstBit = 0;
+
+   return ( recordNumber == 0 );
+}
+
+void BitpackStringDecoder::seekRecord( uint64_t recordNumber, size_t firstBit )
+{
+   BitpackDecoder::seekRecord( recordNumber, firstBit );
+
+   readingPrefix_ = true;
+   prefixLength_ = 1;
+   nBytesPrefixRead_ = 0;
+   stringLength_ = 0;
+   currentString_.clear();
+   nBytesStringRead_ = 0;
+}
+
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
 void BitpackStringDecoder::dump( int indent, std::ostream &os )
 {
@@ -677,8 +754,37 @@ BitpackIntegerDecoder<RegisterT>::BitpackIntegerDecoder( bool isScaledInteger,
                                                                // imf->parentFile()  --> ImageFile?
 
    bitsPerRecord_ = imf->bitsNeeded( minimum_, maximum_ );
-   destBitMask_ =
-      ( bitsPerRecord_ == 64 ) ? ~0 : static_cast<RegisterT>( 1ULL << bitsPerRecord_ ) - 1;
+
+   selectStoreFunction();
+}
+
+template <typename RegisterT>
+void BitpackIntegerDecoder<RegisterT>::destBufferSetNew( std::vector<SourceDestBuffer> &dbufs )
+{
+   BitpackDecoder::destBufferSetNew( dbufs );
+
+   selectStoreFunction();
+}
+
+template <typename RegisterT> void BitpackIntegerDecoder<RegisterT>::selectStoreFunction()
+{
+   // The values we decode are minimum_ plus whatever the bits hold, which may be more than
+   // maximum_ in a bad file. If that can overflow, any value is possible.
+   const uint64_t cMaximumRaw =
+      ( bitsPerRecord_ >= 64 ) ? UINT64_MAX : ( uint64_t{ 1 } << bitsPerRecord_ ) - 1;
+   const uint64_t cHeadroom =
+      static_cast<uint64_t>( INT64_MAX ) - static_cast<uint64_t>( minimum_ );
+
+   int64_t low = INT64_MIN;
+   int64_t high = INT64_MAX;
+
+   if ( cMaximumRaw <= cHeadroom )
+   {
+      low = minimum_;
+      high = static_cast<int64_t>( static_cast<uint64_t>( minimum_ ) + cMaximumRaw );
+   }
+
+   storeFunction_ = destBuffer_->int64BlockStore( isScaledInteger_, low, high, scale_, offset_ );
 }
 
 template <typename RegisterT>
@@ -708,7 +814,7 @@ size_t BitpackIntegerDecoder<RegisterT>::inputProcessAligned( const char *inbuf,
    }
 #endif
 
-   size_t destRecords = destBuffer_->capacity() - destBuffer_->nextIndex();
+   size_t destRecords = destBuffer_->limit() - destBuffer_->nextIndex();
 
    // Precalculate exact number of full records that are in inbuf
    // We can handle the case where don't have a full word at end of inbuf, but
@@ -730,100 +836,32 @@ size_t BitpackIntegerDecoder<RegisterT>::inputProcessAligned( const char *inbuf,
    std::cout << "  recordCount=" << recordCount << std::endl;
 #endif
 
-   auto inp = reinterpret_cast<const RegisterT *>( inbuf );
-   unsigned wordPosition = 0; // The index in inbuf of the word we are currently working on.
-
-   // clang-format off
-   // For example on little endian machine:
-   // Assume: registerT=uint32_t, bitOffset=20, destBitMask=0x00007fff (for a 15 bit value).
-   // inp[wordPosition]                    LLLLLLLL LLLLXXXX XXXXXXXX XXXXXXXX   Note LSB of value is at bit20
-   // inp(wordPosition+1]                  XXXXXXXX XXXXXXXX XXXXXXXX XXXXXHHH   H=high bits of value, X=uninteresting bits
-   // low = inp[i] >> bitOffset            00000000 00000000 0000LLLL LLLLLLLL   L=low bits of value, X=uninteresting bits
-   // high = inp[i+1] << (32-bitOffset)    XXXXXXXX XXXXXXXX XHHH0000 00000000
-   // w = high | low                       XXXXXXXX XXXXXXXX XHHHLLLL LLLLLLLL
-   // destBitmask                          00000000 00000000 01111111 11111111
-   // w & mask                             00000000 00000000 0HHHLLLL LLLLLLLL
-   // clang-format on
+   // Values are packed LSB first, so the input is one little-endian stream of bits whatever the
+   // size of RegisterT. Unpack a block of records at a time (with SIMD instructions if the CPU has
+   // them), then store them.
+   constexpr size_t cBlockRecords = 256;
+   uint64_t rawValues[cBlockRecords];
 
+   const size_t cInputBytes = ( endBit + 7 ) / 8;
    size_t bitOffset = firstBit;
 
-   for ( size_t i = 0; i < recordCount; i++ )
+   for ( size_t done = 0; done < recordCount; done += cBlockRecords )
    {
-      // Get lower word (contains at least the LSbit of the value),
-      RegisterT low = inp[wordPosition];
+      const size_t cCount = std::min( cBlockRecords, recordCount - done );
 
-#ifdef E57_VERBOSE
-      std::cout << "  bitOffset: " << bitOffset << std::endl;
-      std::cout << "  low: " << binaryString( low ) << std::endl;
-#endif
+      unpackBits( inbuf, cInputBytes, bitOffset, bitsPerRecord_, cCount, rawValues );
 
-      RegisterT w;
-      if ( bitOffset == 0 )
-      {
-         // The left shift (used below) is not defined if shift is >= size of
-         // word
-         w = low;
-      }
-      // Avoid reading the next word, unless it is needed
-      // If the last record finishes on the last bit of input, avoid UMR
-      else if ( bitOffset + bitsPerRecord_ <= RegisterBits )
-      {
-         w = low >> bitOffset;
-      }
-      else
+      // Add minimum_ to each value to get back what writer originally sent (in place, in
+      // unsigned arithmetic so a 64-bit range can't overflow)
+      for ( size_t i = 0; i < cCount; i++ )
       {
-         // Get upper word (may or may not contain interesting bits),
-         RegisterT high = inp[wordPosition + 1];
-
-#ifdef E57_VERBOSE
-         std::cout << "  high:" << binaryString( high ) << std::endl;
-#endif
-
-         // Shift high to just above the lower bits, shift low LSBit to bit0,
-         // OR together. Note shifts are logical (not arithmetic) because using
-         // unsigned variables.
-         w = ( high << ( RegisterBits - bitOffset ) ) | ( low >> bitOffset );
+         rawValues[i] += static_cast<uint64_t>( minimum_ );
       }
 
-#ifdef E57_VERBOSE
-      std::cout << "  w:   " << binaryString( w ) << std::endl;
-#endif
-
-      // Mask off uninteresting bits
-      w &= destBitMask_;
+      storeFunction_( *destBuffer_, reinterpret_cast<const int64_t *>( rawValues ), cCount,
+                      scale_, offset_ );
 
-      // Add minimum_ to value to get back what writer originally sent
-      int64_t value = minimum_ + static_cast<uint64_t>( w );
-
-#ifdef E57_VERBOSE
-      std::cout << "  Storing value=" << value << std::endl;
-#endif
-
-      // The parameter isScaledInteger_ determines which version of
-      // setNextInt64 gets called
-      if ( isScaledInteger_ )
-      {
-         destBuffer_->setNextInt64( value, scale_, offset_ );
-      }
-      else
-      {
-         destBuffer_->setNextInt64( value );
-      }
-
-      // Store the result in next available position in the user's dest buffer
-
-      // Calc next bit alignment and which word it starts in
-      bitOffset += bitsPerRecord_;
-      if ( bitOffset >= 8 * sizeof( RegisterT ) )
-      {
-         bitOffset -= 8 * sizeof( RegisterT );
-         wordPosition++;
-      }
-#ifdef E57_VERBOSE
-      std::cout << "  Processed " << i + 1 << " records, wordPosition=" << wordPosition
-                << " decoder:" << std::endl;
-      dump( 4 );
-#endif
+      bitOffset += cCount * bitsPerRecord_;
    }
 
    // Update counts of records processed
@@ -833,6 +871,17 @@ size_t BitpackIntegerDecoder<RegisterT>::inputProcessAligned( const char *inbuf,
    return ( recordCount * bitsPerRecord_ );
 }
 
+template <typename RegisterT>
+bool BitpackIntegerDecoder<RegisterT>::recordPosition( uint64_t recordNumber,
+                                                       uint64_t &byteOffset,
+                                                       size_t &firstBit ) const
+{
+   // Records are packed one after another, so may start anywhere in a word
+   alignedPosition( recordNumber * bitsPerRecord_, byteOffset, firstBit );
+
+   return true;
+}
+
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
 template <typename RegisterT>
 void BitpackIntegerDecoder<RegisterT>::dump( int indent, std::ostream &os )
@@ -844,8 +893,6 @@ void BitpackIntegerDecoder<RegisterT>::dump( int indent, std::ostream &os )
    os << space( indent ) << "scale:            " << scale_ << std::endl;
    os << space( indent ) << "offset:           " << offset_ << std::endl;
    os << space( indent ) << "bitsPerRecord:    " << bitsPerRecord_ << std::endl;
-   os << space( indent ) << "destBitMask:      " << binaryString( destBitMask_ ) << " = "
-      << hexString( destBitMask_ ) << std::endl;
 }
 #endif
 
@@ -884,25 +931,30 @@ size_t ConstantIntegerDecoder::inputProcess( const char *source, const size_t av
    // availableByteCount.
 
    // Fill dest buffer unless get to maxRecordCount
-   size_t count = destBuffer_->capacity() - destBuffer_->nextIndex();
+   size_t count = destBuffer_->limit() - destBuffer_->nextIndex();
    uint64_t remainingRecordCount = maxRecordCount_ - currentRecordIndex_;
    if ( static_cast<uint64_t>( count ) > remainingRecordCount )
    {
       count = static_cast<unsigned>( remainingRecordCount );
    }
 
-   if ( isScaledInteger_ )
+   // Store a block of copies of the value at a time
+   constexpr size_t cBlockRecords = 256;
+   int64_t values[cBlockRecords];
+
+   std::fill( values, values + cBlockRecords, minimum_ );
+
+   for ( size_t done = 0; done < count; done += cBlockRecords )
    {
-      for ( size_t i = 0; i < count; i++ )
+      const size_t cCount = std::min( cBlockRecords, count - done );
+
+      if ( isScaledInteger_ )
       {
-         destBuffer_->setNextInt64( minimum_, scale_, offset_ );
+         destBuffer_->setNextInt64Block( values, cCount, scale_, offset_ );
       }
-   }
-   else
-   {
-      for ( size_t i = 0; i < count; i++ )
+      else
       {
-         destBuffer_->setNextInt64( minimum_ );
+         destBuffer_->setNextInt64Block( values, cCount );
       }
    }
    currentRecordIndex_ += count;
@@ -913,6 +965,21 @@ void ConstantIntegerDecoder::stateReset()
 {
 }
 
+bool ConstantIntegerDecoder::recordPosition( uint64_t /*recordNumber*/, uint64_t &byteOffset,
+                                             size_t &firstBit ) const
+{
+   // Records don't take any space in the bytestream
+   byteOffset = 0;
+   firstBit = 0;
+
+   return true;
+}
+
+void ConstantIntegerDecoder::seekRecord( uint64_t recordNumber, size_t /*firstBit*/ )
+{
+   currentRecordIndex_ = recordNumber;
+}
+
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
 void ConstantIntegerDecoder::dump( int indent, std::ostream &os )
 {
@@ -28,6 +28,7 @@
 #pragma once
 
 #include "Common.h"
+#include "SourceDestBufferImpl.h"
 
 namespace e57
 {
@@ -46,6 +47,15 @@ namespace e57
       virtual size_t inputProcess( const char *source, size_t count ) = 0;
       virtual void stateReset() = 0;
 
+      /// Find where a record (counted from the start of the bytestream) starts: the naturally
+      /// aligned byte to start feeding input from, and the bit in it where the record begins.
+      /// Returns false if this can't be calculated because records vary in length.
+      virtual bool recordPosition( uint64_t recordNumber, uint64_t &byteOffset,
+                                   size_t &firstBit ) const = 0;
+
+      /// Restart decoding at a record, with input fed from the position given by recordPosition()
+      virtual void seekRecord( uint64_t recordNumber, size_t firstBit ) = 0;
+
       unsigned bytestreamNumber() const
       {
          return bytestreamNumber_;
@@ -75,6 +85,7 @@ namespace e57
       virtual size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) = 0;
 
       void stateReset() override;
+      void seekRecord( uint64_t recordNumber, size_t firstBit ) override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
@@ -85,6 +96,7 @@ namespace e57
                       uint64_t maxRecordCount );
 
       void inBufferShiftDown();
+      void alignedPosition( uint64_t bitOffset, uint64_t &byteOffset, size_t &firstBit ) const;
 
       uint64_t currentRecordIndex_ = 0;
       uint64_t maxRecordCount_ = 0;
@@ -106,6 +118,8 @@ namespace e57
                            FloatPrecision precision, uint64_t maxRecordCount );
 
       size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) override;
+      bool recordPosition( uint64_t recordNumber, uint64_t &byteOffset,
+                           size_t &firstBit ) const override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
@@ -122,6 +136,9 @@ namespace e57
                             uint64_t maxRecordCount );
 
       size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) override;
+      bool recordPosition( uint64_t recordNumber, uint64_t &byteOffset,
+                           size_t &firstBit ) const override;
+      void seekRecord( uint64_t recordNumber, size_t firstBit ) override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
@@ -144,21 +161,26 @@ namespace e57
                              SourceDestBuffer &dbuf, int64_t minimum, int64_t maximum, double scale,
                              double offset, uint64_t maxRecordCount );
 
+      void destBufferSetNew( std::vector<SourceDestBuffer> &dbufs ) override;
       size_t inputProcessAligned( const char *inbuf, size_t firstBit, size_t endBit ) override;
+      bool recordPosition( uint64_t recordNumber, uint64_t &byteOffset,
+                           size_t &firstBit ) const override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
 #endif
 
    protected:
+      void selectStoreFunction();
+
+      /// Specialized for the type of destBuffer_ (see SourceDestBufferImpl::int64BlockStore())
+      SourceDestBufferImpl::Int64BlockStore storeFunction_ = nullptr;
       bool isScaledInteger_;
       int64_t minimum_;
       int64_t maximum_;
       double scale_;
       double offset_;
       unsigned bitsPerRecord_;
-      RegisterT destBitMask_;
-      static constexpr size_t RegisterBits = sizeof( RegisterT ) * 8;
    };
 
    class ConstantIntegerDecoder : public Decoder
@@ -176,6 +198,9 @@ namespace e57
 
       size_t inputProcess( const char *source, size_t availableByteCount ) override;
       void stateReset() override;
+      bool recordPosition( uint64_t recordNumber, uint64_t &byteOffset,
+                           size_t &firstBit ) const override;
+      void seekRecord( uint64_t recordNumber, size_t firstBit ) override;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) override;
@@ -36,6 +36,11 @@ namespace e57
    {
    }
 
+   Reader::Reader( std::shared_ptr<IODevice> device, const ReaderOptions &options ) :
+      impl_( new ReaderImpl( std::move( device ), options ) )
+   {
+   }
+
    // Note that this constructor is deprecated (see header).
    Reader::Reader( const ustring &filePath ) : Reader( filePath, {} )
    {
@@ -144,4 +149,16 @@ namespace e57
    {
       return impl_->SetUpData3DPointsData( dataIndex, pointCount, buffers );
    }
+
+   size_t Reader::ReadData3DRange( int64_t dataIndex, int64_t startPoint, size_t pointCount,
+                                   const Data3DPointsFloat &buffers ) const
+   {
+      return impl_->ReadData3DRange( dataIndex, startPoint, pointCount, buffers );
+   }
+
+   size_t Reader::ReadData3DRange( int64_t dataIndex, int64_t startPoint, size_t pointCount,
+                                   const Data3DPointsDouble &buffers ) const
+   {
+      return impl_->ReadData3DRange( dataIndex, startPoint, pointCount, buffers );
+   }
 } // end namespace e57
@@ -150,6 +150,11 @@ namespace e57
    {
    }
 
+   Writer::Writer( std::shared_ptr<IODevice> device, const WriterOptions &options ) :
+      impl_( new WriterImpl( std::move( device ), options ) )
+   {
+   }
+
    // Note that this constructor is deprecated (see header).
    Writer::Writer( const ustring &filePath, const ustring &coordinateMetadata ) :
       Writer( filePath, WriterOptions{ {}, coordinateMetadata } )
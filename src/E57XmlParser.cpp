@@ -205,8 +205,8 @@ XMLSize_t E57FileInputStream::readBytes( XMLByte *const toFill, const XMLSize_t
 
    size_t readCount = std::min( maxToRead_size, available_size );
 
-   cf_->seek( logicalPosition_ );
-   cf_->read( reinterpret_cast<char *>( toFill ), readCount ); //??? cast ok?
+   cf_->readAt( logicalPosition_, reinterpret_cast<char *>( toFill ),
+                readCount ); //??? cast ok?
    logicalPosition_ += readCount;
    return ( readCount );
 }
@@ -433,13 +433,13 @@ uint64_t BitpackFloatEncoder::processRecords( size_t recordCount )
       auto outp = reinterpret_cast<float *>( &outBuffer_[outBufferEnd_] );
 
       // Copy floats from sourceBuffer_ to outBuffer_
+      sourceBuffer_->getNextFloatBlock( outp, recordCount );
+#ifdef E57_VERBOSE
       for ( unsigned i = 0; i < recordCount; i++ )
       {
-         outp[i] = sourceBuffer_->getNextFloat();
-#ifdef E57_VERBOSE
          std::cout << "encoding float: " << outp[i] << std::endl;
-#endif
       }
+#endif
    }
    else
    {
@@ -448,13 +448,13 @@ uint64_t BitpackFloatEncoder::processRecords( size_t recordCount )
       auto outp = reinterpret_cast<double *>( &outBuffer_[outBufferEnd_] );
 
       // Copy doubles from sourceBuffer_ to outBuffer_
+      sourceBuffer_->getNextDoubleBlock( outp, recordCount );
+#ifdef E57_VERBOSE
       for ( unsigned i = 0; i < recordCount; i++ )
       {
-         outp[i] = sourceBuffer_->getNextDouble();
-#ifdef E57_VERBOSE
          std::cout << "encoding double: " << outp[i] << std::endl;
-#endif
       }
+#endif
    }
 
    // Update end of outBuffer
@@ -723,21 +723,33 @@ uint64_t BitpackIntegerEncoder<RegisterT>::processRecords( size_t recordCount )
    auto outp = reinterpret_cast<RegisterT *>( &outBuffer_[outBufferEnd_] );
    unsigned outTransferred = 0;
 
+   // Values are fetched from sourceBuffer_ a block at a time
+   constexpr size_t cBlockRecords = 256;
+   int64_t rawValues[cBlockRecords];
+
    // Copy bits from sourceBuffer_ to outBuffer_
    for ( unsigned i = 0; i < recordCount; i++ )
    {
-      int64_t rawValue;
+      const size_t cBlockIndex = i % cBlockRecords;
 
-      // The parameter isScaledInteger_ determines which version of getNextInt64 gets called
-      if ( isScaledInteger_ )
-      {
-         rawValue = sourceBuffer_->getNextInt64( scale_, offset_ );
-      }
-      else
+      if ( cBlockIndex == 0 )
       {
-         rawValue = sourceBuffer_->getNextInt64();
+         const size_t cCount = std::min( cBlockRecords, recordCount - i );
+
+         // The parameter isScaledInteger_ determines which version of getNextInt64Block gets
+         // called
+         if ( isScaledInteger_ )
+         {
+            sourceBuffer_->getNextInt64Block( rawValues, cCount, scale_, offset_ );
+         }
+         else
+         {
+            sourceBuffer_->getNextInt64Block( rawValues, cCount );
+         }
       }
 
+      const int64_t rawValue = rawValues[cBlockIndex];
+
       // Enforce min/max specification on value
       if ( rawValue < minimum_ || maximum_ < rawValue )
       {
@@ -908,14 +920,23 @@ uint64_t ConstantIntegerEncoder::processRecords( size_t recordCount )
    dump( 4 );
 #endif
 
-   // Check that all source values are == minimum_
-   for ( unsigned i = 0; i < recordCount; i++ )
+   // Check that all source values are == minimum_, a block at a time
+   constexpr size_t cBlockRecords = 256;
+   int64_t values[cBlockRecords];
+
+   for ( size_t done = 0; done < recordCount; done += cBlockRecords )
    {
-      int64_t nextInt64 = sourceBuffer_->getNextInt64();
-      if ( nextInt64 != minimum_ )
+      const size_t cCount = std::min( cBlockRecords, recordCount - done );
+
+      sourceBuffer_->getNextInt64Block( values, cCount );
+
+      for ( size_t i = 0; i < cCount; i++ )
       {
-         throw E57_EXCEPTION2( ErrorValueOutOfBounds, "nextInt64=" + toString( nextInt64 ) +
-                                                         " minimum=" + toString( minimum_ ) );
+         if ( values[i] != minimum_ )
+         {
+            throw E57_EXCEPTION2( ErrorValueOutOfBounds, "nextInt64=" + toString( values[i] ) +
+                                                            " minimum=" + toString( minimum_ ) );
+         }
       }
    }
 
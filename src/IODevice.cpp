@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: BSL-1.0
+// Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+
+#include "E57Format.h"
+
+namespace e57
+{
+   // Devices are read-only unless these are overridden
+
+   int64_t IODevice::writeAt( uint64_t /*offset*/, const char * /*buffer*/, size_t /*count*/ )
+   {
+      return -1;
+   }
+
+   bool IODevice::resize( uint64_t /*newSize*/ )
+   {
+      return false;
+   }
+}
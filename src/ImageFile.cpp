@@ -189,6 +189,18 @@ The ImageFile state can transition to the closed state in two ways. The programm
 ImageFile::close after all required processing has completed. The programmer can call
 ImageFile::cancel if it is determined that the ImageFile is no longer needed.
 
+@section imagefile_Threads Threads
+An ImageFile opened in read mode may be shared by several threads. Each thread can look up nodes in
+the tree and read the compressed vectors using its own CompressedVectorReader (for example one
+thread per data3D scan), without opening the file again. Each CompressedVectorReader must only be
+used by one thread at a time. Decoding the records is not serialized. Inside the library, reading
+pages from the file (which includes verifying their checksums and counting the I/O statistics) is
+done under one lock. Prefetching packets on a background thread (for files read with
+ReadMethodStream) shares its buffers between readers under a separate lock. The access-pattern
+hints given to the OS are not locked, since they don't change any state shared by the readers.
+
+An ImageFile opened in write mode must only be used by one thread at a time.
+
 @section imagefile_Extensions Extensions
 Basically in an E57 file, "extension = namespace + rules + meaning".
 The "namespace" ensures that element names don't collide.
@@ -248,7 +260,7 @@ have all the required element names required by ASTM E57 file format standard us
 @c "._e57".
 @param [in] mode Either "w" for writing or "r" for reading.
 @param [in] checksumPolicy The percentage of checksums we compute and verify as an int. Clamped to
-0-100.
+0-100 unless it is ::ChecksumBackground, which verifies all checksums on a separate thread.
 
 @par Write Mode
 In write mode, the file cannot be already open.
@@ -285,7 +297,30 @@ CompressedVectorNode, E57Exception, E57Utilities::E57Utilities
 */
 ImageFile::ImageFile( const ustring &fname, const ustring &mode,
                       ReadChecksumPolicy checksumPolicy ) :
-   impl_( new ImageFileImpl( checksumPolicy ) )
+   ImageFile( fname, mode, checksumPolicy, ReadMethodStream )
+{
+}
+
+/*!
+@brief Open an ASTM E57 imaging data file for reading/writing, choosing how it is read.
+
+@details This works the same way as the constructor without @a readMethod, but in read mode the
+file is accessed using @a readMethod.
+
+@param [in] fname File name to open.
+@param [in] mode Either "w" for writing or "r" for reading.
+@param [in] checksumPolicy The percentage of checksums we compute and verify as an int. Clamped to
+0-100 unless it is ::ChecksumBackground, which verifies all checksums on a separate thread.
+@param [in] readMethod How the file is accessed in read mode (see ::ReadMethod). Ignored in write
+mode.
+
+@post Resulting ImageFile is in @c open state if constructor succeeds (no exception thrown).
+
+@see ReadMethod
+*/
+ImageFile::ImageFile( const ustring &fname, const ustring &mode,
+                      ReadChecksumPolicy checksumPolicy, ReadMethod readMethod ) :
+   impl_( new ImageFileImpl( checksumPolicy, readMethod ) )
 {
    // Do second phase of construction, now that ImageFile object is complete.
    impl_->construct2( fname, mode );
@@ -297,6 +332,45 @@ ImageFile::ImageFile( const char *input, const uint64_t size, ReadChecksumPolicy
    impl_->construct2( input, size );
 }
 
+/*!
+@brief Open an ImageFile stored in an IODevice for reading, or create one for writing.
+
+@details This works the same way as opening a file on disk (see ImageFile( const ustring &, const
+ustring &, ReadChecksumPolicy )), but all access goes through @a device. The ImageFile
+keeps a reference to the device until it is closed.
+
+In write mode, the device is emptied first, and it must implement IODevice::writeAt() and
+IODevice::resize().
+
+@param [in] device The device holding the E57 data.
+@param [in] mode Either "w" for writing or "r" for reading.
+@param [in] checksumPolicy The percentage of checksums we compute and verify as an int. Clamped to
+0-100 unless it is ::ChecksumBackground.
+
+@post Resulting ImageFile is in @c open state if constructor succeeds (no exception thrown).
+
+@throw ::ErrorBadAPIArgument (n/c)
+@throw ::ErrorOpenFailed (n/c)
+@throw ::ErrorReadFailed (n/c)
+@throw ::ErrorWriteFailed (n/c)
+@throw ::ErrorBadChecksum (n/c)
+@throw ::ErrorBadFileSignature (n/c)
+@throw ::ErrorUnknownFileVersion (n/c)
+@throw ::ErrorBadFileLength (n/c)
+@throw ::ErrorXMLParserInit (n/c)
+@throw ::ErrorXMLParser (n/c)
+@throw ::ErrorBadXMLFormat (n/c)
+@throw ::ErrorInternal All objects in undocumented state
+
+@see IODevice
+*/
+ImageFile::ImageFile( std::shared_ptr<IODevice> device, const ustring &mode,
+                      ReadChecksumPolicy checksumPolicy ) :
+   impl_( new ImageFileImpl( checksumPolicy ) )
+{
+   impl_->construct2( std::move( device ), mode );
+}
+
 /*!
 @brief Get the pre-established root StructureNode of the E57 ImageFile.
 
@@ -464,6 +538,29 @@ int ImageFile::readerCount() const
    return impl_->readerCount();
 }
 
+/*!
+@brief Get counters describing the I/O done by the ImageFile so far.
+
+@details
+This is useful for finding out where the time goes when reading or writing a large file: waiting
+for the disk (IOStatistics::ioNanoseconds, IOStatistics::readCalls), calculating checksums
+(IOStatistics::checksumNanoseconds), or elsewhere (for example decoding compressed vectors).
+
+After the ImageFile is closed, this returns the final counts.
+
+@post No visible state is modified.
+
+@return A snapshot of the ImageFile's I/O statistics.
+
+@throw No E57Exceptions.
+
+@see IOStatistics, ReadChecksumPolicy
+*/
+IOStatistics ImageFile::ioStatistics() const
+{
+   return impl_->ioStatistics();
+}
+
 /*!
 @brief Declare the use of an E57 extension in an ImageFile being written.
 
@@ -74,9 +74,12 @@ namespace e57
    }
 #endif
 
-   ImageFileImpl::ImageFileImpl( ReadChecksumPolicy policy ) :
+   ImageFileImpl::ImageFileImpl( ReadChecksumPolicy policy, ReadMethod readMethod ) :
       isWriter_( false ), writerCount_( 0 ), readerCount_( 0 ),
-      checksumPolicy( std::max( 0, std::min( policy, 100 ) ) ), file_( nullptr ),
+      checksumPolicy( ( policy == ChecksumBackground ) ? policy
+                                                       : std::max( 0, std::min( policy, 100 ) ) ),
+      readMethod_( readMethod ),
+      file_( nullptr ),
       xmlLogicalOffset_( 0 ), xmlLogicalLength_( 0 ), unusedLogicalStart_( 0 )
    {
       // First phase of construction, can't do much until have the ImageFile object. See
@@ -90,12 +93,8 @@ namespace e57
 #ifdef E57_VERBOSE
       std::cout << "ImageFileImpl() called, fileName=" << fileName << " mode=" << mode << std::endl;
 #endif
-      unusedLogicalStart_ = sizeof( E57FileHeader );
       fileName_ = fileName;
 
-      // Get shared_ptr to this object
-      ImageFileImplSharedPtr imf = shared_from_this();
-
       // Accept "w" or "r" modes
       isWriter_ = ( mode == "w" );
 
@@ -106,122 +105,105 @@ namespace e57
 
       file_ = nullptr;
 
-      // Writing
       if ( isWriter_ )
       {
-         try
-         {
-            // Open file for writing, truncate if already exists.
-            file_ = new CheckedFile( fileName_, CheckedFile::Write, checksumPolicy );
+         // Open file for writing, truncate if already exists.
+         file_ = new CheckedFile( fileName_, CheckedFile::Write, checksumPolicy );
+      }
+      else
+      {
+         // Open file for reading.
+         const CheckedFile::Mode cReadMode =
+            ( readMethod_ == ReadMethodMemoryMap ) ? CheckedFile::ReadMemoryMap : CheckedFile::Read;
 
-            std::shared_ptr<StructureNodeImpl> root( new StructureNodeImpl( imf ) );
-            root_ = root;
-            root_->setAttachedRecursive();
+         file_ = new CheckedFile( fileName_, cReadMode, checksumPolicy );
+      }
 
-            unusedLogicalStart_ = sizeof( E57FileHeader );
-            xmlLogicalOffset_ = 0;
-            xmlLogicalLength_ = 0;
-         }
-         catch ( ... )
-         {
-            delete file_;
-            file_ = nullptr;
+      construct3();
+   }
 
-            throw;
-         }
+   void ImageFileImpl::construct2( const char *input, const uint64_t size )
+   {
+      // Second phase of construction, now we have a well-formed ImageFile object.
 
-         return;
-      }
+#ifdef E57_VERBOSE
+      std::cout << "ImageFileImpl() called, fileName=<StreamBuffer> mode=r" << std::endl;
+#endif
+      fileName_ = "<StreamBuffer>";
 
-      // Reading
-      try
-      {
-         // Open file for reading.
-         file_ = new CheckedFile( fileName_, CheckedFile::Read, checksumPolicy );
+      isWriter_ = false;
+      file_ = nullptr;
 
-         std::shared_ptr<StructureNodeImpl> root( new StructureNodeImpl( imf ) );
-         root_ = root;
-         root_->setAttachedRecursive();
+      // Open file for reading.
+      file_ = new CheckedFile( input, size, checksumPolicy );
 
-         E57FileHeader header;
-         readFileHeader( file_, header );
+      construct3();
+   }
 
-         xmlLogicalOffset_ = file_->physicalToLogical( header.xmlPhysicalOffset );
-         xmlLogicalLength_ = header.xmlLogicalLength;
-      }
-      catch ( ... )
-      {
-         delete file_;
-         file_ = nullptr;
+   void ImageFileImpl::construct2( std::shared_ptr<IODevice> device, const ustring &mode )
+   {
+      // Second phase of construction, now we have a well-formed ImageFile object.
 
-         throw;
-      }
+#ifdef E57_VERBOSE
+      std::cout << "ImageFileImpl() called, fileName=<IODevice> mode=" << mode << std::endl;
+#endif
+      fileName_ = "<IODevice>";
 
-      try
+      if ( device == nullptr )
       {
-         // Create parser state, attach its event handers to the SAX2 reader
-         E57XmlParser parser( imf );
+         throw E57_EXCEPTION2( ErrorBadAPIArgument, "device=nullptr" );
+      }
 
-         parser.init();
+      // Accept "w" or "r" modes
+      isWriter_ = ( mode == "w" );
 
-         // Create input source (XML section of E57 file turned into a stream).
-         E57XmlFileInputSource xmlSection( file_, xmlLogicalOffset_, xmlLogicalLength_ );
+      if ( !isWriter_ && ( mode != "r" ) )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument, "mode=" + ustring( mode ) );
+      }
 
-         unusedLogicalStart_ = sizeof( E57FileHeader );
+      file_ = nullptr;
 
-         // Do the parse, building up the node tree
-         parser.parse( xmlSection );
-      }
-      catch ( ... )
-      {
-         delete file_;
-         file_ = nullptr;
+      const CheckedFile::Mode cMode = isWriter_ ? CheckedFile::Write : CheckedFile::Read;
 
-         throw;
-      }
+      file_ = new CheckedFile( std::move( device ), cMode, checksumPolicy );
+
+      construct3();
    }
 
-   void ImageFileImpl::construct2( const char *input, const uint64_t size )
+   void ImageFileImpl::construct3()
    {
-      // Second phase of construction, now we have a well-formed ImageFile object.
-
-#ifdef E57_VERBOSE
-      std::cout << "ImageFileImpl() called, fileName=<StreamBuffer> mode=r" << std::endl;
-#endif
-      unusedLogicalStart_ = sizeof( E57FileHeader );
-      fileName_ = "<StreamBuffer>";
+      // Last phase of construction, common to all construct2() variants. file_ is open, so set up
+      // a new tree for writing, or read the header & XML section to build the tree for reading.
 
       // Get shared_ptr to this object
       ImageFileImplSharedPtr imf = shared_from_this();
 
-      isWriter_ = false;
-      file_ = nullptr;
+      unusedLogicalStart_ = sizeof( E57FileHeader );
 
       try
       {
-         // Open file for reading.
-         file_ = new CheckedFile( input, size, checksumPolicy );
-
          std::shared_ptr<StructureNodeImpl> root( new StructureNodeImpl( imf ) );
          root_ = root;
          root_->setAttachedRecursive();
 
+         if ( isWriter_ )
+         {
+            xmlLogicalOffset_ = 0;
+            xmlLogicalLength_ = 0;
+
+            return;
+         }
+
          E57FileHeader header;
          readFileHeader( file_, header );
 
          xmlLogicalOffset_ = file_->physicalToLogical( header.xmlPhysicalOffset );
          xmlLogicalLength_ = header.xmlLogicalLength;
-      }
-      catch ( ... )
-      {
-         delete file_;
-         file_ = nullptr;
 
-         throw;
-      }
+         // The XML section is read once from start to end, then never again
+         file_->adviseAccess( xmlLogicalOffset_, xmlLogicalLength_, CheckedFile::AccessWillNeed );
 
-      try
-      {
          // Create parser state, attach its event handers to the SAX2 reader
          E57XmlParser parser( imf );
 
@@ -230,10 +212,10 @@ namespace e57
          // Create input source (XML section of E57 file turned into a stream).
          E57XmlFileInputSource xmlSection( file_, xmlLogicalOffset_, xmlLogicalLength_ );
 
-         unusedLogicalStart_ = sizeof( E57FileHeader );
-
          // Do the parse, building up the node tree
          parser.parse( xmlSection );
+
+         file_->adviseAccess( xmlLogicalOffset_, xmlLogicalLength_, CheckedFile::AccessDontNeed );
       }
       catch ( ... )
       {
@@ -295,10 +277,31 @@ namespace e57
 #endif
 
          // Write header at beginning of file
-         file_->seek( 0 );
-         file_->write( reinterpret_cast<char *>( &header ), sizeof( header ) );
+         file_->writeAt( 0, reinterpret_cast<char *>( &header ), sizeof( header ) );
 
          file_->close();
+
+         ioStatistics_ = file_->statistics();
+      }
+      else
+      {
+         // Closing reports any bad checksums found in the background (ChecksumBackground).
+         // We're closed whether it throws or not.
+         std::unique_ptr<CheckedFile> file( file_ );
+         file_ = nullptr;
+
+         try
+         {
+            file->close();
+         }
+         catch ( ... )
+         {
+            ioStatistics_ = file->statistics();
+            throw;
+         }
+
+         ioStatistics_ = file->statistics();
+         return;
       }
 
       delete file_;
@@ -324,6 +327,8 @@ namespace e57
          file_->close();
       }
 
+      ioStatistics_ = file_->statistics();
+
       delete file_;
       file_ = nullptr;
    }
@@ -348,6 +353,16 @@ namespace e57
       return readerCount_;
    }
 
+   IOStatistics ImageFileImpl::ioStatistics() const
+   {
+      if ( file_ == nullptr )
+      {
+         return ioStatistics_;
+      }
+
+      return file_->statistics();
+   }
+
    ImageFileImpl::~ImageFileImpl()
    {
       // Try to cancel if not already closed, but don't allow any exceptions to propagate to caller
@@ -374,7 +389,7 @@ namespace e57
       unusedLogicalStart_ += byteCount;
 
       // If caller won't write to file immediately, it should request that the file be extended with
-      // zeros here.
+      // zeros here. Large extensions are reserved without writing anything (see CheckedFile).
       if ( doExtendNow )
       {
          file_->extend( unusedLogicalStart_ );
@@ -648,7 +663,7 @@ namespace e57
       {
          throw E57_EXCEPTION2( ErrorInternal, "fileName=" + fileName_ +
                                                  " writerCount=" + toString( writerCount_ ) +
-                                                 " readerCount=" + toString( readerCount_ ) );
+                                                 " readerCount=" + toString( readerCount() ) );
       }
 #endif
    }
@@ -667,7 +682,7 @@ namespace e57
       {
          throw E57_EXCEPTION2( ErrorInternal, "fileName=" + fileName_ +
                                                  " writerCount=" + toString( writerCount_ ) +
-                                                 " readerCount=" + toString( readerCount_ ) );
+                                                 " readerCount=" + toString( readerCount() ) );
       }
 #endif
    }
@@ -840,7 +855,7 @@ namespace e57
       // no checkImageFileOpen(__FILE__, __LINE__, __FUNCTION__)
       os << space( indent ) << "fileName:    " << fileName_ << std::endl;
       os << space( indent ) << "writerCount: " << writerCount_ << std::endl;
-      os << space( indent ) << "readerCount: " << readerCount_ << std::endl;
+      os << space( indent ) << "readerCount: " << readerCount() << std::endl;
       os << space( indent ) << "isWriter:    " << isWriter_ << std::endl;
       for ( size_t i = 0; i < extensionsCount(); i++ )
       {
@@ -858,7 +873,7 @@ namespace e57
       static_assert( sizeof( E57FileHeader ) == 48, "Unexpected size of E57FileHeader" );
 
       // Fetch the file header
-      file->read( reinterpret_cast<char *>( &header ), sizeof( header ) );
+      file->readAt( 0, reinterpret_cast<char *>( &header ), sizeof( header ) );
 
 #ifdef E57_VERBOSE
       header.dump();
@@ -27,6 +27,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include "Common.h"
@@ -41,10 +42,11 @@ namespace e57
    class ImageFileImpl : public std::enable_shared_from_this<ImageFileImpl>
    {
    public:
-      explicit ImageFileImpl( ReadChecksumPolicy policy );
+      explicit ImageFileImpl( ReadChecksumPolicy policy, ReadMethod readMethod = ReadMethodStream );
 
       void construct2( const ustring &fileName, const ustring &mode );
       void construct2( const char *input, uint64_t size );
+      void construct2( std::shared_ptr<IODevice> device, const ustring &mode );
 
       std::shared_ptr<StructureNodeImpl> root();
 
@@ -54,6 +56,7 @@ namespace e57
       bool isWriter() const;
       int writerCount() const;
       int readerCount() const;
+      IOStatistics ioStatistics() const;
       ~ImageFileImpl();
 
       uint64_t allocateSpace( uint64_t byteCount, bool doExtendNow );
@@ -98,6 +101,8 @@ namespace e57
       friend class CompressedVectorWriterImpl;
       friend class CompressedVectorReaderImpl;
 
+      void construct3();
+
       static void readFileHeader( CheckedFile *file, E57FileHeader &header );
 
       void checkImageFileOpen( const char *srcFileName, int srcLineNumber,
@@ -106,12 +111,16 @@ namespace e57
       ustring fileName_;
       bool isWriter_;
       int writerCount_;
-      int readerCount_;
+      std::atomic<int> readerCount_; // readers of a read-only file may be on different threads
 
       ReadChecksumPolicy checksumPolicy;
+      ReadMethod readMethod_;
 
       CheckedFile *file_;
 
+      // I/O statistics of file_ when it was closed
+      IOStatistics ioStatistics_;
+
       // Read file attributes
       uint64_t xmlLogicalOffset_;
       uint64_t xmlLogicalLength_;
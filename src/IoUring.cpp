@@ -0,0 +1,309 @@
+// SPDX-License-Identifier: BSL-1.0
+// Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+
+#include "IoUring.h"
+
+#ifdef E57_IO_URING
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace e57;
+
+namespace
+{
+   template <typename T> T *ringPointer( void *ring, uint32_t offset )
+   {
+      return reinterpret_cast<T *>( static_cast<char *>( ring ) + offset );
+   }
+
+   // Ask the kernel which operations it supports. IORING_OP_READ and IORING_OP_WRITE (and the
+   // probe itself) were added in Linux 5.6, after io_uring itself (5.1).
+   bool supportsReadWrite( int fd )
+   {
+      constexpr unsigned cProbeOps = 256;
+
+      std::vector<char> buffer( sizeof( io_uring_probe ) +
+                                cProbeOps * sizeof( io_uring_probe_op ) );
+
+      auto *probe = reinterpret_cast<io_uring_probe *>( buffer.data() );
+
+      if ( ::syscall( __NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, cProbeOps ) < 0 )
+      {
+         return false;
+      }
+
+      const auto isSupported = [probe]( uint8_t opcode ) {
+         return ( opcode <= probe->last_op ) &&
+                ( ( probe->ops[opcode].flags & IO_URING_OP_SUPPORTED ) != 0 );
+      };
+
+      return isSupported( IORING_OP_READ ) && isSupported( IORING_OP_WRITE );
+   }
+}
+
+IoUring::IoUring( unsigned entries )
+{
+   io_uring_params params;
+   memset( &params, 0, sizeof( params ) );
+
+   const auto fd = static_cast<int>( ::syscall( __NR_io_uring_setup, entries, &params ) );
+
+   if ( fd < 0 )
+   {
+      // Not supported by this kernel, or not allowed (e.g. seccomp). Leave us invalid.
+      return;
+   }
+
+   // Kernels before 5.6 have io_uring, but not the read & write operations we use
+   if ( !supportsReadWrite( fd ) )
+   {
+      ::close( fd );
+      return;
+   }
+
+   sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+   cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+
+   // Newer kernels map both rings with one call
+   const bool cSingleMap = ( params.features & IORING_FEAT_SINGLE_MMAP ) != 0;
+
+   if ( cSingleMap )
+   {
+      sqRingSize_ = cqRingSize_ = std::max( sqRingSize_, cqRingSize_ );
+   }
+
+   void *sqRing = ::mmap( nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd, IORING_OFF_SQ_RING );
+
+   if ( sqRing == MAP_FAILED )
+   {
+      ::close( fd );
+      return;
+   }
+
+   void *cqRing = sqRing;
+
+   if ( !cSingleMap )
+   {
+      cqRing = ::mmap( nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                       IORING_OFF_CQ_RING );
+
+      if ( cqRing == MAP_FAILED )
+      {
+         ::munmap( sqRing, sqRingSize_ );
+         ::close( fd );
+         return;
+      }
+   }
+
+   sqesSize_ = params.sq_entries * sizeof( io_uring_sqe );
+
+   void *sqes = ::mmap( nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                        IORING_OFF_SQES );
+
+   if ( sqes == MAP_FAILED )
+   {
+      if ( !cSingleMap )
+      {
+         ::munmap( cqRing, cqRingSize_ );
+      }
+
+      ::munmap( sqRing, sqRingSize_ );
+      ::close( fd );
+      return;
+   }
+
+   ringFd_ = fd;
+   sqRing_ = sqRing;
+   cqRing_ = cqRing;
+   sqes_ = static_cast<io_uring_sqe *>( sqes );
+
+   sqEntries_ = params.sq_entries;
+   sqHead_ = ringPointer<unsigned>( sqRing_, params.sq_off.head );
+   sqTail_ = ringPointer<unsigned>( sqRing_, params.sq_off.tail );
+   sqMask_ = ringPointer<unsigned>( sqRing_, params.sq_off.ring_mask );
+   sqArray_ = ringPointer<unsigned>( sqRing_, params.sq_off.array );
+
+   cqHead_ = ringPointer<unsigned>( cqRing_, params.cq_off.head );
+   cqTail_ = ringPointer<unsigned>( cqRing_, params.cq_off.tail );
+   cqMask_ = ringPointer<unsigned>( cqRing_, params.cq_off.ring_mask );
+   cqes_ = ringPointer<io_uring_cqe>( cqRing_, params.cq_off.cqes );
+}
+
+IoUring::~IoUring()
+{
+   if ( ringFd_ < 0 )
+   {
+      return;
+   }
+
+   // The kernel may still be using our callers' buffers, so wait for everything to finish
+   if ( toSubmit_ > 0 )
+   {
+      submit();
+   }
+
+   while ( inFlight_ > 0 )
+   {
+      if ( ( enter( 1 ) < 0 ) && ( errno != EINTR ) )
+      {
+         break;
+      }
+
+      // Throw away the completions
+      unsigned head = *cqHead_;
+      const unsigned tail = __atomic_load_n( cqTail_, __ATOMIC_ACQUIRE );
+
+      while ( head != tail )
+      {
+         ++head;
+         --inFlight_;
+      }
+
+      __atomic_store_n( cqHead_, head, __ATOMIC_RELEASE );
+   }
+
+   ::munmap( sqes_, sqesSize_ );
+
+   if ( cqRing_ != sqRing_ )
+   {
+      ::munmap( cqRing_, cqRingSize_ );
+   }
+
+   ::munmap( sqRing_, sqRingSize_ );
+   ::close( ringFd_ );
+}
+
+bool IoUring::isValid() const
+{
+   return ringFd_ >= 0;
+}
+
+bool IoUring::queueRead( int fd, char *buf, size_t count, uint64_t offset, uint64_t userData )
+{
+   return queue( IORING_OP_READ, fd, buf, count, offset, userData );
+}
+
+bool IoUring::queueWrite( int fd, const char *buf, size_t count, uint64_t offset,
+                          uint64_t userData )
+{
+   return queue( IORING_OP_WRITE, fd, buf, count, offset, userData );
+}
+
+bool IoUring::queue( uint8_t opcode, int fd, const char *buf, size_t count, uint64_t offset,
+                     uint64_t userData )
+{
+   const unsigned tail = *sqTail_;
+   const unsigned head = __atomic_load_n( sqHead_, __ATOMIC_ACQUIRE );
+
+   if ( tail - head >= sqEntries_ )
+   {
+      return false;
+   }
+
+   const unsigned index = tail & *sqMask_;
+
+   io_uring_sqe &sqe = sqes_[index];
+   memset( &sqe, 0, sizeof( sqe ) );
+
+   sqe.opcode = opcode;
+   sqe.fd = fd;
+   sqe.addr = reinterpret_cast<uint64_t>( buf );
+   sqe.len = static_cast<uint32_t>( count );
+   sqe.off = offset;
+   sqe.user_data = userData;
+
+   sqArray_[index] = index;
+
+   __atomic_store_n( sqTail_, tail + 1, __ATOMIC_RELEASE );
+
+   ++toSubmit_;
+
+   return true;
+}
+
+void IoUring::submit()
+{
+   while ( toSubmit_ > 0 )
+   {
+      const int result = enter( 0 );
+
+      // If we can't submit now, wait() will try again
+      if ( ( result == 0 ) || ( ( result < 0 ) && ( errno != EINTR ) ) )
+      {
+         break;
+      }
+   }
+}
+
+int32_t IoUring::wait( uint64_t userData )
+{
+   for ( ;; )
+   {
+      // Reap whatever has completed
+      unsigned head = *cqHead_;
+      const unsigned tail = __atomic_load_n( cqTail_, __ATOMIC_ACQUIRE );
+
+      while ( head != tail )
+      {
+         const io_uring_cqe &cqe = cqes_[head & *cqMask_];
+
+         completed_[cqe.user_data] = cqe.res;
+
+         ++head;
+         --inFlight_;
+      }
+
+      __atomic_store_n( cqHead_, head, __ATOMIC_RELEASE );
+
+      const auto found = completed_.find( userData );
+
+      if ( found != completed_.end() )
+      {
+         const int32_t result = found->second;
+
+         completed_.erase( found );
+
+         return result;
+      }
+
+      if ( ( toSubmit_ == 0 ) && ( inFlight_ == 0 ) )
+      {
+         // Nothing with this userData was ever queued
+         return -EINVAL;
+      }
+
+      if ( ( enter( 1 ) < 0 ) && ( errno != EINTR ) && ( errno != EAGAIN ) )
+      {
+         return -errno;
+      }
+   }
+}
+
+int IoUring::enter( unsigned waitCount )
+{
+   const unsigned flags = ( waitCount > 0 ) ? IORING_ENTER_GETEVENTS : 0;
+
+   const auto result = static_cast<int>(
+      ::syscall( __NR_io_uring_enter, ringFd_, toSubmit_, waitCount, flags, nullptr, 0 ) );
+
+   if ( result > 0 )
+   {
+      const auto submitted = static_cast<unsigned>( result );
+
+      toSubmit_ -= submitted;
+      inFlight_ += submitted;
+   }
+
+   return result;
+}
+
+#endif
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: BSL-1.0
+// Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+
+#pragma once
+
+#ifdef E57_IO_URING
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace e57
+{
+   /// @brief Minimal wrapper around a Linux io_uring instance used by CheckedFile
+   /// @details This talks to the kernel directly (no liburing) and only supports what CheckedFile
+   /// needs: queueing reads & writes at an offset and waiting for them to complete.
+   ///
+   /// If the kernel does not support io_uring or its read & write operations (Linux 5.6+), or it
+   /// is blocked, isValid() returns false and the caller should use regular POSIX I/O.
+   class IoUring
+   {
+   public:
+      explicit IoUring( unsigned entries );
+      ~IoUring();
+
+      IoUring( const IoUring & ) = delete;
+      IoUring &operator=( const IoUring & ) = delete;
+
+      bool isValid() const;
+
+      /// Queue a read or write. Returns false if the submission queue is full.
+      bool queueRead( int fd, char *buf, size_t count, uint64_t offset, uint64_t userData );
+      bool queueWrite( int fd, const char *buf, size_t count, uint64_t offset, uint64_t userData );
+
+      /// Pass everything queued to the kernel without waiting for it.
+      void submit();
+
+      /// Wait for the request with this userData to complete and return its result
+      /// (number of bytes, or -errno).
+      int32_t wait( uint64_t userData );
+
+   private:
+      bool queue( uint8_t opcode, int fd, const char *buf, size_t count, uint64_t offset,
+                  uint64_t userData );
+      int enter( unsigned waitCount );
+
+      int ringFd_ = -1;
+
+      void *sqRing_ = nullptr;
+      void *cqRing_ = nullptr;
+      size_t sqRingSize_ = 0;
+      size_t cqRingSize_ = 0;
+
+      io_uring_sqe *sqes_ = nullptr;
+      size_t sqesSize_ = 0;
+
+      unsigned sqEntries_ = 0;
+      unsigned *sqHead_ = nullptr;
+      unsigned *sqTail_ = nullptr;
+      unsigned *sqMask_ = nullptr;
+      unsigned *sqArray_ = nullptr;
+
+      unsigned *cqHead_ = nullptr;
+      unsigned *cqTail_ = nullptr;
+      unsigned *cqMask_ = nullptr;
+      io_uring_cqe *cqes_ = nullptr;
+
+      unsigned toSubmit_ = 0; // queued but not yet passed to the kernel
+      unsigned inFlight_ = 0; // passed to the kernel but not yet completed
+
+      std::map<uint64_t, int32_t> completed_; // completions we haven't been asked for yet
+   };
+}
+
+#endif
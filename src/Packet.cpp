@@ -50,16 +50,15 @@ struct EmptyPacketHeader
 //=============================================================================
 // PacketReadCache
 
-PacketReadCache::PacketReadCache( CheckedFile *cFile, unsigned packetCount ) :
-   cFile_( cFile ), entries_( packetCount )
+constexpr unsigned PacketReadCache::defaultPacketCount;
+
+PacketReadCache::PacketReadCache( CheckedFile *cFile, unsigned packetCount ) : cFile_( cFile )
 {
-   if ( packetCount == 0 )
-   {
-      throw E57_EXCEPTION2( ErrorInternal, "packetCount=" + toString( packetCount ) );
-   }
+   resize( packetCount );
 }
 
-std::unique_ptr<PacketLock> PacketReadCache::lock( uint64_t packetLogicalOffset, char *&pkt )
+std::unique_ptr<PacketLock> PacketReadCache::lock( uint64_t packetLogicalOffset,
+                                                   const char *&pkt )
 {
 #ifdef E57_VERBOSE
    std::cout << "PacketReadCache::lock() called, packetLogicalOffset=" << packetLogicalOffset
@@ -79,64 +78,105 @@ std::unique_ptr<PacketLock> PacketReadCache::lock( uint64_t packetLogicalOffset,
                             "packetLogicalOffset=" + toString( packetLogicalOffset ) );
    }
 
-   // Linear scan for matching packet offset in cache
-   for ( unsigned i = 0; i < entries_.size(); ++i )
+   unsigned entryIndex = 0;
+
+   const auto found = index_.find( packetLogicalOffset );
+
+   if ( found != index_.end() )
    {
-      auto &entry = entries_[i];
+      // Found a match, so don't have to read anything
+      entryIndex = found->second;
+
+#ifdef E57_VERBOSE
+      std::cout << "  Found matching cache entry, index=" << entryIndex << std::endl;
+#endif
+   }
+   else
+   {
+      // Reuse the least recently used (LRU) entry
+      entryIndex = lru_.back();
 
-      if ( packetLogicalOffset == entry.logicalOffset_ )
-      {
-         // Found a match, so don't have to read anything
 #ifdef E57_VERBOSE
-         std::cout << "  Found matching cache entry, index=" << i << std::endl;
+      std::cout << "  Oldest entry=" << entryIndex << std::endl;
 #endif
-         // Mark entry with current useCount (keeps track of age of entry).
-         entry.lastUsed_ = ++useCount_;
 
-         // Publish buffer address to caller
-         pkt = entry.buffer_;
+      readPacket( entryIndex, packetLogicalOffset );
+   }
 
-         // Create lock so we are sure that we will be unlocked when use is finished.
-         std::unique_ptr<PacketLock> plock( new PacketLock( this, i ) );
+   touch( entryIndex );
 
-         // Increment cache lock just before return
-         ++lockCount_;
+   // Publish packet address to caller
+   pkt = entries_[entryIndex].packet_;
 
-         return plock;
-      }
+   // Create lock so we are sure that we will be unlocked when use is finished.
+   std::unique_ptr<PacketLock> plock( new PacketLock( this, entryIndex ) );
+
+   // Increment cache lock just before return
+   ++lockCount_;
+
+   return plock;
+}
+
+void PacketReadCache::resize( unsigned packetCount )
+{
+   if ( packetCount == 0 )
+   {
+      throw E57_EXCEPTION2( ErrorInternal, "packetCount=" + toString( packetCount ) );
+   }
+
+   // Can't move entries while someone is using one
+   if ( lockCount_ > 0 )
+   {
+      throw E57_EXCEPTION2( ErrorInternal, "lockCount=" + toString( lockCount_ ) );
    }
-   // Get here if didn't find a match already in cache.
 
-   // Find least recently used (LRU) packet buffer
-   unsigned oldestEntry = 0;
-   unsigned oldestUsed = entries_.at( 0 ).lastUsed_;
+   // Move the most recently used packets which fit to the front of the new entries
+   std::vector<CacheEntry> entries( packetCount );
+   unsigned kept = 0;
 
-   for ( unsigned i = 0; i < entries_.size(); ++i )
+   for ( const unsigned i : lru_ )
    {
-      const auto &entry = entries_[i];
+      if ( kept == packetCount )
+      {
+         break;
+      }
 
-      if ( entry.lastUsed_ < oldestUsed )
+      if ( entries_[i].logicalOffset_ == 0 )
       {
-         oldestEntry = i;
-         oldestUsed = entry.lastUsed_;
+         continue;
       }
+
+      // Moving buffer_ keeps its storage, so packet_ stays valid
+      entries[kept++] = std::move( entries_[i] );
    }
-#ifdef E57_VERBOSE
-   std::cout << "  Oldest entry=" << oldestEntry << " lastUsed=" << oldestUsed << std::endl;
-#endif
 
-   readPacket( oldestEntry, packetLogicalOffset );
+   entries_.swap( entries );
 
-   // Publish buffer address to caller
-   pkt = entries_[oldestEntry].buffer_;
+   lru_.clear();
+   index_.clear();
 
-   // Create lock so we are sure we will be unlocked when use is finished.
-   std::unique_ptr<PacketLock> plock( new PacketLock( this, oldestEntry ) );
+   for ( unsigned i = 0; i < packetCount; ++i )
+   {
+      auto &entry = entries_[i];
 
-   // Increment cache lock just before return
-   ++lockCount_;
+      entry.lruPosition_ = lru_.insert( lru_.end(), i );
 
-   return plock;
+      if ( entry.logicalOffset_ != 0 )
+      {
+         index_[entry.logicalOffset_] = i;
+      }
+   }
+}
+
+unsigned PacketReadCache::size() const
+{
+   return static_cast<unsigned>( entries_.size() );
+}
+
+void PacketReadCache::touch( unsigned entryIndex )
+{
+   // Move the entry to the front of the LRU list
+   lru_.splice( lru_.begin(), lru_, entries_[entryIndex].lruPosition_ );
 }
 
 void PacketReadCache::unlock( unsigned cacheIndex )
@@ -156,10 +196,10 @@ void PacketReadCache::unlock( unsigned cacheIndex )
    --lockCount_;
 }
 
-void PacketReadCache::readPacket( unsigned oldestEntry, uint64_t packetLogicalOffset )
+void PacketReadCache::readPacket( unsigned entryIndex, uint64_t packetLogicalOffset )
 {
 #ifdef E57_VERBOSE
-   std::cout << "PacketReadCache::readPacket() called, oldestEntry=" << oldestEntry
+   std::cout << "PacketReadCache::readPacket() called, entryIndex=" << entryIndex
              << " packetLogicalOffset=" << packetLogicalOffset << std::endl;
 #endif
 
@@ -167,8 +207,7 @@ void PacketReadCache::readPacket( unsigned oldestEntry, uint64_t packetLogicalOf
    // common to all packets.
    EmptyPacketHeader header;
 
-   cFile_->seek( packetLogicalOffset, CheckedFile::Logical );
-   cFile_->read( reinterpret_cast<char *>( &header ), sizeof( header ) );
+   cFile_->readAt( packetLogicalOffset, reinterpret_cast<char *>( &header ), sizeof( header ) );
 
    // Can't verify packet header here, because it is not really an EmptyPacketHeader.
    unsigned packetLength = header.packetLogicalLengthMinus1 + 1;
@@ -179,18 +218,35 @@ void PacketReadCache::readPacket( unsigned oldestEntry, uint64_t packetLogicalOf
       throw E57_EXCEPTION2( ErrorBadCVPacket, "packetLength=" + toString( packetLength ) );
    }
 
-   auto &entry = entries_.at( oldestEntry );
+   auto &entry = entries_.at( entryIndex );
 
-   // Now read in whole packet into preallocated buffer_.  Note buffer is
-   cFile_->seek( packetLogicalOffset, CheckedFile::Logical );
-   cFile_->read( entry.buffer_, packetLength );
+   // Invalidate the entry in case reading or verifying the packet fails
+   if ( entry.logicalOffset_ != 0 )
+   {
+      index_.erase( entry.logicalOffset_ );
+      entry.logicalOffset_ = 0;
+   }
+
+   // If the file is in memory, use the packet where it is (if it's suitably aligned for the packet
+   // structures). Otherwise read in whole packet into preallocated buffer_.
+   entry.packet_ = cFile_->readInPlace( packetLogicalOffset, packetLength );
+
+   if ( ( entry.packet_ == nullptr ) ||
+        ( reinterpret_cast<uintptr_t>( entry.packet_ ) % alignof( IndexPacket ) != 0 ) )
+   {
+      entry.buffer_.resize( DATA_PACKET_MAX );
+
+      cFile_->readAt( packetLogicalOffset, entry.buffer_.data(), packetLength );
+
+      entry.packet_ = entry.buffer_.data();
+   }
 
    // Verify that packet is good.
    switch ( header.packetType )
    {
       case DATA_PACKET:
       {
-         auto dpkt = reinterpret_cast<DataPacket *>( entry.buffer_ );
+         auto dpkt = reinterpret_cast<const DataPacket *>( entry.packet_ );
 
          dpkt->verify( packetLength );
 #ifdef E57_VERBOSE
@@ -201,7 +257,7 @@ void PacketReadCache::readPacket( unsigned oldestEntry, uint64_t packetLogicalOf
       break;
       case INDEX_PACKET:
       {
-         auto ipkt = reinterpret_cast<IndexPacket *>( entry.buffer_ );
+         auto ipkt = reinterpret_cast<const IndexPacket *>( entry.packet_ );
 
          ipkt->verify( packetLength );
 #ifdef E57_VERBOSE
@@ -212,7 +268,7 @@ void PacketReadCache::readPacket( unsigned oldestEntry, uint64_t packetLogicalOf
       break;
       case EMPTY_PACKET:
       {
-         auto hp = reinterpret_cast<EmptyPacketHeader *>( entry.buffer_ );
+         auto hp = reinterpret_cast<const EmptyPacketHeader *>( entry.packet_ );
 
          hp->verify( packetLength );
 #ifdef E57_VERBOSE
@@ -227,50 +283,47 @@ void PacketReadCache::readPacket( unsigned oldestEntry, uint64_t packetLogicalOf
 
    entry.logicalOffset_ = packetLogicalOffset;
 
-   // Mark entry with current useCount (keeps track of age of entry).
-   // This is a cache, so a small hiccup when useCount_ overflows won't hurt.
-   entry.lastUsed_ = ++useCount_;
+   index_[packetLogicalOffset] = entryIndex;
 }
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
 void PacketReadCache::dump( int indent, std::ostream &os )
 {
    os << space( indent ) << "lockCount: " << lockCount_ << std::endl;
-   os << space( indent ) << "useCount:  " << useCount_ << std::endl;
-   os << space( indent ) << "entries:" << std::endl;
-   for ( unsigned i = 0; i < entries_.size(); i++ )
+   os << space( indent ) << "entries (most recently used first):" << std::endl;
+   for ( const unsigned i : lru_ )
    {
       os << space( indent ) << "entry[" << i << "]:" << std::endl;
       os << space( indent + 4 ) << "logicalOffset:  " << entries_[i].logicalOffset_ << std::endl;
-      os << space( indent + 4 ) << "lastUsed:        " << entries_[i].lastUsed_ << std::endl;
       if ( entries_[i].logicalOffset_ != 0 )
       {
          os << space( indent + 4 ) << "packet:" << std::endl;
-         switch ( reinterpret_cast<EmptyPacketHeader *>( entries_.at( i ).buffer_ )->packetType )
+
+         const auto packetType =
+            reinterpret_cast<const EmptyPacketHeader *>( entries_.at( i ).packet_ )->packetType;
+
+         switch ( packetType )
          {
             case DATA_PACKET:
             {
-               auto dpkt = reinterpret_cast<DataPacket *>( entries_.at( i ).buffer_ );
+               auto dpkt = reinterpret_cast<const DataPacket *>( entries_.at( i ).packet_ );
                dpkt->dump( indent + 6, os );
             }
             break;
             case INDEX_PACKET:
             {
-               auto ipkt = reinterpret_cast<IndexPacket *>( entries_.at( i ).buffer_ );
+               auto ipkt = reinterpret_cast<const IndexPacket *>( entries_.at( i ).packet_ );
                ipkt->dump( indent + 6, os );
             }
             break;
             case EMPTY_PACKET:
             {
-               auto hp = reinterpret_cast<EmptyPacketHeader *>( entries_.at( i ).buffer_ );
+               auto hp = reinterpret_cast<const EmptyPacketHeader *>( entries_.at( i ).packet_ );
                hp->dump( indent + 6, os );
             }
             break;
             default:
-               throw E57_EXCEPTION2(
-                  ErrorInternal, "packetType=" + toString( reinterpret_cast<EmptyPacketHeader *>(
-                                                              entries_.at( i ).buffer_ )
-                                                              ->packetType ) );
+               throw E57_EXCEPTION2( ErrorInternal, "packetType=" + toString( packetType ) );
          }
       }
    }
@@ -435,7 +488,7 @@ void DataPacket::verify( unsigned bufferLength ) const
    }
 }
 
-char *DataPacket::getBytestream( unsigned bytestreamNumber, unsigned &byteCount )
+const char *DataPacket::getBytestream( unsigned bytestreamNumber, unsigned &byteCount ) const
 {
 #ifdef E57_VERBOSE
    std::cout << "getBytestream called, bytestreamNumber=" << bytestreamNumber << std::endl;
@@ -456,8 +509,8 @@ char *DataPacket::getBytestream( unsigned bytestreamNumber, unsigned &byteCount
    }
 
    // Calc positions in packet
-   auto bsbLength = reinterpret_cast<uint16_t *>( &payload[0] );
-   auto streamBase = reinterpret_cast<char *>( &bsbLength[header.bytestreamCount] );
+   auto bsbLength = reinterpret_cast<const uint16_t *>( &payload[0] );
+   auto streamBase = reinterpret_cast<const char *>( &bsbLength[header.bytestreamCount] );
 
    // Sum size of preceding stream buffers to get position
    unsigned totalPreceding = 0;
@@ -483,7 +536,7 @@ char *DataPacket::getBytestream( unsigned bytestreamNumber, unsigned &byteCount
    return ( &streamBase[totalPreceding] );
 }
 
-unsigned DataPacket::getBytestreamBufferLength( unsigned bytestreamNumber )
+unsigned DataPacket::getBytestreamBufferLength( unsigned bytestreamNumber ) const
 {
    //??? for now:
    unsigned byteCount;
@@ -28,6 +28,8 @@
 #pragma once
 
 #include <cstdint>
+#include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "Common.h"
@@ -48,13 +50,22 @@ namespace e57
    // Maximum size of CompressedVector binary data packet
    constexpr int DATA_PACKET_MAX = ( 64 * 1024 );
 
+   // LRU cache of packets read from a compressed vector's binary section, indexed by logical
+   // offset. Lookup, use, and eviction are all O(1).
    class PacketReadCache
    {
    public:
+      // default number of packets held in the cache
+      static constexpr unsigned defaultPacketCount = 32;
+
       PacketReadCache( CheckedFile *cFile, unsigned packetCount );
 
-      std::unique_ptr<PacketLock> lock( uint64_t packetLogicalOffset,
-                                        char *&pkt ); //??? pkt could be const
+      // The packet may be in read-only memory (see CheckedFile::readInPlace()), so it is const
+      std::unique_ptr<PacketLock> lock( uint64_t packetLogicalOffset, const char *&pkt );
+
+      // Change the number of packets held, keeping the most recently used ones
+      void resize( unsigned packetCount );
+      unsigned size() const;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout );
@@ -66,20 +77,34 @@ namespace e57
       // Only PacketLock can unlock the cache
       void unlock( unsigned cacheIndex );
 
-      void readPacket( unsigned oldestEntry, uint64_t packetLogicalOffset );
+      void readPacket( unsigned entryIndex, uint64_t packetLogicalOffset );
+      void touch( unsigned entryIndex );
 
       struct CacheEntry
       {
-         uint64_t logicalOffset_ = 0;
-         char buffer_[DATA_PACKET_MAX]; // No need to init since it's a data buffer
-         unsigned lastUsed_ = 0;
+         uint64_t logicalOffset_ = 0; // 0 if the entry is empty
+
+         // Only allocated (DATA_PACKET_MAX bytes) when a packet has to be copied out of the file
+         std::vector<char> buffer_; // No need to init since it's a data buffer
+
+         // The packet: either buffer_, or the packet itself if the file is in memory and it
+         // doesn't cross a page boundary (see CheckedFile::readInPlace())
+         const char *packet_ = nullptr;
+
+         // This entry's position in lru_
+         std::list<unsigned>::iterator lruPosition_;
       };
 
       unsigned lockCount_ = 0;
-      unsigned useCount_ = 0;
       CheckedFile *cFile_ = nullptr;
 
       std::vector<CacheEntry> entries_;
+
+      // Indices of entries_ from most to least recently used
+      std::list<unsigned> lru_;
+
+      // Index in entries_ of each packet in the cache, by logical offset
+      std::unordered_map<uint64_t, unsigned> index_;
    };
 
    class PacketLock
@@ -134,8 +159,8 @@ namespace e57
       DataPacket();
 
       void verify( unsigned bufferLength = 0 ) const;
-      char *getBytestream( unsigned bytestreamNumber, unsigned &byteCount );
-      unsigned getBytestreamBufferLength( unsigned bytestreamNumber );
+      const char *getBytestream( unsigned bytestreamNumber, unsigned &byteCount ) const;
+      unsigned getBytestreamBufferLength( unsigned bytestreamNumber ) const;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
       void dump( int indent = 0, std::ostream &os = std::cout ) const;
@@ -192,7 +192,17 @@ namespace e57
    }
 
    ReaderImpl::ReaderImpl( const ustring &filePath, const ReaderOptions &options ) :
-      imf_( filePath, "r", options.checksumPolicy ), root_( imf_.root() ),
+      ReaderImpl( ImageFile( filePath, "r", options.checksumPolicy, options.readMethod ), options )
+   {
+   }
+
+   ReaderImpl::ReaderImpl( std::shared_ptr<IODevice> device, const ReaderOptions &options ) :
+      ReaderImpl( ImageFile( std::move( device ), "r", options.checksumPolicy ), options )
+   {
+   }
+
+   ReaderImpl::ReaderImpl( const ImageFile &imf, const ReaderOptions &options ) :
+      imf_( imf ), options_( options ), root_( imf_.root() ),
       data3D_( root_.isDefined( "/data3D" ) ? root_.get( "/data3D" ) : VectorNode( imf_ ) ),
       images2D_( root_.isDefined( "/images2D" ) ? root_.get( "/images2D" ) : VectorNode( imf_ ) )
    {
@@ -202,7 +212,23 @@ namespace e57
    {
       if ( IsOpen() )
       {
-         Close();
+         // Closing may report a bad checksum (ChecksumBackground), but we can't throw from here.
+         // Callers who need to know must call Close() themselves (see ReaderOptions).
+         try
+         {
+            Close();
+         }
+         catch ( E57Exception &e )
+         {
+#ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
+            e.report( __FILE__, __LINE__, __FUNCTION__, std::cerr );
+#else
+            E57_UNUSED( e );
+#endif
+         }
+         catch ( ... )
+         {
+         }
       }
    }
 
@@ -1794,9 +1820,31 @@ namespace e57
 
       CompressedVectorReader reader = points.reader( destBuffers );
 
+      reader.setPacketCacheSize( options_.packetCacheSize );
+      reader.setDecodeThreadCount( options_.decodeThreadCount );
+
       return reader;
    }
 
+   // Reads a range of the point data
+   template <typename COORDTYPE>
+   size_t ReaderImpl::ReadData3DRange( int64_t dataIndex, int64_t startPoint, size_t pointCount,
+                                       const Data3DPointsData_t<COORDTYPE> &buffers ) const
+   {
+      if ( startPoint < 0 )
+      {
+         throw E57_EXCEPTION2( ErrorBadAPIArgument, "startPoint=" + toString( startPoint ) );
+      }
+
+      CompressedVectorReader reader = SetUpData3DPointsData( dataIndex, pointCount, buffers );
+
+      const size_t cCount = reader.read( static_cast<uint64_t>( startPoint ), pointCount );
+
+      reader.close();
+
+      return cCount;
+   }
+
    int64_t ReaderImpl::GetData3DCount() const
    {
       return data3D_.childCount();
@@ -1829,4 +1877,12 @@ namespace e57
    template CompressedVectorReader ReaderImpl::SetUpData3DPointsData(
       int64_t dataIndex, size_t pointCount, const Data3DPointsData_t<double> &buffers ) const;
 
+   template size_t ReaderImpl::ReadData3DRange( int64_t dataIndex, int64_t startPoint,
+                                                size_t pointCount,
+                                                const Data3DPointsData_t<float> &buffers ) const;
+
+   template size_t ReaderImpl::ReadData3DRange( int64_t dataIndex, int64_t startPoint,
+                                                size_t pointCount,
+                                                const Data3DPointsData_t<double> &buffers ) const;
+
 } // end namespace e57
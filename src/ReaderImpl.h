@@ -37,6 +37,7 @@ namespace e57
    {
    public:
       ReaderImpl( const ustring &filePath, const ReaderOptions &options );
+      ReaderImpl( std::shared_ptr<IODevice> device, const ReaderOptions &options );
       ~ReaderImpl();
 
       // disallow copying a ReaderImpl
@@ -79,6 +80,10 @@ namespace e57
       CompressedVectorReader SetUpData3DPointsData(
          int64_t dataIndex, size_t pointCount, const Data3DPointsData_t<COORDTYPE> &buffers ) const;
 
+      template <typename COORDTYPE>
+      size_t ReadData3DRange( int64_t dataIndex, int64_t startPoint, size_t pointCount,
+                              const Data3DPointsData_t<COORDTYPE> &buffers ) const;
+
       StructureNode GetRawE57Root() const;
 
       VectorNode GetRawData3D() const;
@@ -88,7 +93,10 @@ namespace e57
       ImageFile GetRawIMF() const;
 
    private:
+      ReaderImpl( const ImageFile &imf, const ReaderOptions &options );
+
       ImageFile imf_;
+      ReaderOptions options_;
       StructureNode root_;
 
       VectorNode data3D_;
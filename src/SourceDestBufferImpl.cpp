@@ -26,6 +26,9 @@
  */
 
 #include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 
 #include "ImageFileImpl.h"
 #include "SourceDestBufferImpl.h"
@@ -33,11 +36,266 @@
 
 using namespace e57;
 
+namespace
+{
+   // Call function( element, i ) for each of count elements of a buffer of T whose elements are
+   // stride bytes apart. Packed buffers get a loop of their own, which the compiler can vectorize.
+   template <typename T, typename Function>
+   void forEachElement( char *base, size_t stride, size_t count, Function function )
+   {
+      if ( stride == sizeof( T ) )
+      {
+         auto *elements = reinterpret_cast<T *>( base );
+
+         for ( size_t i = 0; i < count; i++ )
+         {
+            function( elements[i], i );
+         }
+
+         return;
+      }
+
+      for ( size_t i = 0; i < count; i++ )
+      {
+         function( *reinterpret_cast<T *>( base + i * stride ), i );
+      }
+   }
+
+   template <typename T, typename Function>
+   void forEachElement( const char *base, size_t stride, size_t count, Function function )
+   {
+      if ( stride == sizeof( T ) )
+      {
+         auto *elements = reinterpret_cast<const T *>( base );
+
+         for ( size_t i = 0; i < count; i++ )
+         {
+            function( elements[i], i );
+         }
+
+         return;
+      }
+
+      for ( size_t i = 0; i < count; i++ )
+      {
+         function( *reinterpret_cast<const T *>( base + i * stride ), i );
+      }
+   }
+
+   // Copy values out of a buffer of SourceT, converting each one with a cast
+   template <typename SourceT, typename T>
+   void loadElements( const char *base, size_t stride, T *values, size_t count )
+   {
+      forEachElement<SourceT>( base, stride, count, [values]( const SourceT &element, size_t i ) {
+         values[i] = static_cast<T>( element );
+      } );
+   }
+
+   // Copy values into a buffer of DestT, converting each one with a cast
+   template <typename DestT, typename T>
+   void storeElements( char *base, size_t stride, const T *values, size_t count )
+   {
+      forEachElement<DestT>( base, stride, count, [values]( DestT &element, size_t i ) {
+         element = static_cast<DestT>( values[i] );
+      } );
+   }
+
+   // Whether no element of a buffer of T is below low or above high. As in the single element
+   // checks, a NaN counts as being within the range. There is no early exit, so the loop can be
+   // vectorized.
+   template <typename T>
+   bool allWithin( const char *base, size_t stride, size_t count, double low, double high )
+   {
+      bool outside = false;
+
+      forEachElement<T>( base, stride, count, [&outside, low, high]( const T &value, size_t ) {
+         outside |= ( value < low ) || ( high < value );
+      } );
+
+      return !outside;
+   }
+
+   void minMax( const int64_t *values, size_t count, int64_t &low, int64_t &high )
+   {
+      // Locals, so the compiler doesn't have to store them on every iteration in case they alias
+      // values
+      int64_t minimum = std::numeric_limits<int64_t>::max();
+      int64_t maximum = std::numeric_limits<int64_t>::min();
+
+      for ( size_t i = 0; i < count; i++ )
+      {
+         minimum = std::min( minimum, values[i] );
+         maximum = std::max( maximum, values[i] );
+      }
+
+      low = minimum;
+      high = maximum;
+   }
+
+   // Whether a value fits in a DestT buffer, as setNextInt64() checks it
+   template <typename DestT> bool fits( int64_t value, std::true_type /*isIntegral*/ )
+   {
+      return ( std::numeric_limits<DestT>::min() <= value ) &&
+             ( value <= std::numeric_limits<DestT>::max() );
+   }
+
+   template <typename DestT> bool fits( int64_t /*value*/, std::false_type /*isIntegral*/ )
+   {
+      return true;
+   }
+
+   // Whether all the values fit in a DestT buffer
+   template <typename DestT>
+   bool allFit( const int64_t *values, size_t count, std::true_type /*isIntegral*/ )
+   {
+      // Any value fits in an int64_t
+      if ( sizeof( DestT ) == sizeof( int64_t ) )
+      {
+         return true;
+      }
+
+      // Adding the bias maps DestT's range onto [0, 2^bits), so a value fits if none of the bits
+      // above that are set. OR-ing them all together (rather than finding the smallest and
+      // largest) lets the loop be vectorized.
+      const uint64_t cBias =
+         0 - static_cast<uint64_t>( static_cast<int64_t>( std::numeric_limits<DestT>::min() ) );
+      const unsigned cBits = 8 * sizeof( DestT ) % 64;
+
+      uint64_t bits = 0;
+
+      for ( size_t i = 0; i < count; i++ )
+      {
+         bits |= static_cast<uint64_t>( values[i] ) + cBias;
+      }
+
+      return ( bits >> cBits ) == 0;
+   }
+
+   template <typename DestT>
+   bool allFit( const int64_t * /*values*/, size_t /*count*/, std::false_type /*isIntegral*/ )
+   {
+      return true;
+   }
+
+   // Scale a value for a DestT buffer as setNextInt64( value, scale, offset ) does: integers are
+   // rounded to the nearest, floating point values keep full resolution.
+   template <typename DestT> double scaleValue( int64_t value, double scale, double offset )
+   {
+      return std::is_integral<DestT>::value ? std::floor( value * scale + offset + 0.5 )
+                                            : value * scale + offset;
+   }
+
+   template <typename DestT> bool scaledFits( double scaledValue, std::true_type /*isIntegral*/ )
+   {
+      return ( static_cast<double>( std::numeric_limits<DestT>::min() ) <= scaledValue ) &&
+             ( scaledValue <= static_cast<double>( std::numeric_limits<DestT>::max() ) );
+   }
+
+   template <typename DestT> bool scaledFits( double scaledValue, std::false_type /*isIntegral*/ )
+   {
+      // Any result can be stored in a double
+      return std::is_same<DestT, double>::value ||
+             ( ( DOUBLE_MIN <= scaledValue ) && ( scaledValue <= DOUBLE_MAX ) );
+   }
+
+   // Whether the scaled values in [low, high] all fit in a DestT buffer. Scaling (and rounding)
+   // is monotonic, so the ends of the range of values give the ends of the range of results.
+   template <typename DestT>
+   bool scaledRangeFits( int64_t low, int64_t high, double scale, double offset )
+   {
+      using IsIntegral = typename std::is_integral<DestT>::type;
+
+      return scaledFits<DestT>( scaleValue<DestT>( low, scale, offset ), IsIntegral() ) &&
+             scaledFits<DestT>( scaleValue<DestT>( high, scale, offset ), IsIntegral() );
+   }
+
+   // Whether all the values, once scaled, fit in a DestT buffer
+   template <typename DestT>
+   bool allScaledFit( const int64_t *values, size_t count, double scale, double offset )
+   {
+      if ( std::is_same<DestT, double>::value )
+      {
+         return true;
+      }
+
+      int64_t low;
+      int64_t high;
+      minMax( values, count, low, high );
+
+      return scaledRangeFits<DestT>( low, high, scale, offset );
+   }
+
+   // Scale integers and store them in a DestT buffer
+   template <typename DestT>
+   void storeScaledElements( char *base, size_t stride, const int64_t *values, size_t count,
+                             double scale, double offset )
+   {
+      forEachElement<DestT>(
+         base, stride, count, [values, scale, offset]( DestT &element, size_t i ) {
+            element = static_cast<DestT>( scaleValue<DestT>( values[i], scale, offset ) );
+         } );
+   }
+
+   // Store floating point values in a DestT buffer, if they are all within [low, high]
+   template <typename DestT, typename T>
+   bool storeRealsWithin( char *base, size_t stride, const T *values, size_t count, double low,
+                          double high )
+   {
+      if ( !allWithin<T>( reinterpret_cast<const char *>( values ), sizeof( T ), count, low,
+                          high ) )
+      {
+         return false;
+      }
+
+      storeElements<DestT>( base, stride, values, count );
+
+      return true;
+   }
+
+   template <typename DestT, typename T>
+   bool storeRealsAsIntegers( char *base, size_t stride, const T *values, size_t count )
+   {
+      return storeRealsWithin<DestT>( base, stride, values, count,
+                                      static_cast<double>( std::numeric_limits<DestT>::min() ),
+                                      static_cast<double>( std::numeric_limits<DestT>::max() ) );
+   }
+
+   // Undo the scaling of a value as getNextInt64( scale, offset ) does: calc (x-offset)/scale
+   // rounded to the nearest integer, but keep it in floating point until sure it is in bounds.
+   template <typename SourceT> double unscaleValue( SourceT value, double scale, double offset )
+   {
+      return std::floor( ( value - offset ) / scale + 0.5 );
+   }
+
+   // Read values from a SourceT buffer and undo their scaling. Returns false if any result
+   // doesn't fit in an int64_t, leaving the contents of values unspecified.
+   template <typename SourceT>
+   bool loadUnscaled( const char *base, size_t stride, int64_t *values, size_t count,
+                      double scale, double offset )
+   {
+      bool outside = false;
+
+      forEachElement<SourceT>(
+         base, stride, count,
+         [values, scale, offset, &outside]( const SourceT &element, size_t i ) {
+            const double cRawValue = unscaleValue( element, scale, offset );
+            const bool cOutside = ( cRawValue < static_cast<double>( INT64_MIN ) ) ||
+                                  ( cRawValue > static_cast<double>( INT64_MAX ) );
+
+            values[i] = cOutside ? 0 : static_cast<int64_t>( cRawValue );
+            outside |= cOutside;
+         } );
+
+      return !outside;
+   }
+}
+
 SourceDestBufferImpl::SourceDestBufferImpl( ImageFileImplWeakPtr destImageFile,
                                             const ustring &pathName, const size_t capacity,
                                             bool doConversion, bool doScaling ) :
    destImageFile_( destImageFile ), pathName_( pathName ), memoryRepresentation_( Int32 ),
-   capacity_( capacity ), doConversion_( doConversion ), doScaling_( doScaling )
+   capacity_( capacity ), limit_( capacity ), doConversion_( doConversion ),
+   doScaling_( doScaling )
 {
 }
 
@@ -120,6 +378,7 @@ SourceDestBufferImpl::SourceDestBufferImpl( ImageFileImplWeakPtr destImageFile,
    }
 
    capacity_ = b->size();
+   limit_ = capacity_;
 
    checkState_();
 
@@ -949,6 +1208,495 @@ void SourceDestBufferImpl::setNextDouble( double value )
    _setNextReal( value );
 }
 
+void SourceDestBufferImpl::getNextInt64Block( int64_t *values, size_t count )
+{
+   /// don't checkImageFileOpen
+
+   const char *p = nextElements( count );
+
+   /// Bool and floating point buffers are only read as integers if conversion was requested
+   const bool cNeedsConversion =
+      ( memoryRepresentation_ == Bool ) || ( memoryRepresentation_ == Real32 ) ||
+      ( memoryRepresentation_ == Real64 );
+
+   bool transferred = doConversion_ || !cNeedsConversion;
+
+   if ( transferred )
+   {
+      switch ( memoryRepresentation_ )
+      {
+         case Int8:
+            loadElements<int8_t>( p, stride_, values, count );
+            break;
+         case UInt8:
+            loadElements<uint8_t>( p, stride_, values, count );
+            break;
+         case Int16:
+            loadElements<int16_t>( p, stride_, values, count );
+            break;
+         case UInt16:
+            loadElements<uint16_t>( p, stride_, values, count );
+            break;
+         case Int32:
+            loadElements<int32_t>( p, stride_, values, count );
+            break;
+         case UInt32:
+            loadElements<uint32_t>( p, stride_, values, count );
+            break;
+         case Int64:
+            loadElements<int64_t>( p, stride_, values, count );
+            break;
+         case Bool:
+            loadElements<bool>( p, stride_, values, count );
+            break;
+         case Real32:
+            //??? fault if get special value: NaN, NegInf...
+            loadElements<float>( p, stride_, values, count );
+            break;
+         case Real64:
+            loadElements<double>( p, stride_, values, count );
+            break;
+         default:
+            transferred = false;
+            break;
+      }
+   }
+
+   if ( transferred )
+   {
+      advance( count );
+      return;
+   }
+
+   /// Let the single element version report the error
+   for ( size_t i = 0; i < count; i++ )
+   {
+      values[i] = getNextInt64();
+   }
+}
+
+void SourceDestBufferImpl::getNextInt64Block( int64_t *values, size_t count, double scale,
+                                              double offset )
+{
+   /// don't checkImageFileOpen
+
+   /// If the user did not request scaling, then we get raw values from user's buffer.
+   if ( !doScaling_ )
+   {
+      getNextInt64Block( values, count );
+      return;
+   }
+
+   const char *p = nextElements( count );
+
+   /// Floating point buffers are only read as integers if conversion was requested
+   const bool cNeedsConversion =
+      ( memoryRepresentation_ == Real32 ) || ( memoryRepresentation_ == Real64 );
+
+   /// Values which don't fit in an int64_t, a zero scale, and missing conversions are left to
+   /// the single element version, which reports them.
+   bool transferred = ( scale != 0 ) && ( doConversion_ || !cNeedsConversion );
+
+   if ( transferred )
+   {
+      switch ( memoryRepresentation_ )
+      {
+         case Int8:
+            transferred = loadUnscaled<int8_t>( p, stride_, values, count, scale, offset );
+            break;
+         case UInt8:
+            transferred = loadUnscaled<uint8_t>( p, stride_, values, count, scale, offset );
+            break;
+         case Int16:
+            transferred = loadUnscaled<int16_t>( p, stride_, values, count, scale, offset );
+            break;
+         case UInt16:
+            transferred = loadUnscaled<uint16_t>( p, stride_, values, count, scale, offset );
+            break;
+         case Int32:
+            transferred = loadUnscaled<int32_t>( p, stride_, values, count, scale, offset );
+            break;
+         case UInt32:
+            transferred = loadUnscaled<uint32_t>( p, stride_, values, count, scale, offset );
+            break;
+         case Int64:
+            transferred = loadUnscaled<int64_t>( p, stride_, values, count, scale, offset );
+            break;
+         case Bool:
+            transferred = loadUnscaled<bool>( p, stride_, values, count, scale, offset );
+            break;
+         case Real32:
+            transferred = loadUnscaled<float>( p, stride_, values, count, scale, offset );
+            break;
+         case Real64:
+            transferred = loadUnscaled<double>( p, stride_, values, count, scale, offset );
+            break;
+         default:
+            transferred = false;
+            break;
+      }
+   }
+
+   if ( transferred )
+   {
+      advance( count );
+      return;
+   }
+
+   for ( size_t i = 0; i < count; i++ )
+   {
+      values[i] = getNextInt64( scale, offset );
+   }
+}
+
+template <typename T> void SourceDestBufferImpl::_getNextRealBlock( T *values, size_t count )
+{
+   static_assert( std::is_same<T, double>::value || std::is_same<T, float>::value,
+                  "_getNextRealBlock() requires float or double type" );
+
+   /// don't checkImageFileOpen
+
+   const char *p = nextElements( count );
+
+   /// Integer and Bool buffers are only read as floating point if conversion was requested
+   const bool cNeedsConversion =
+      ( memoryRepresentation_ != Real32 ) && ( memoryRepresentation_ != Real64 );
+
+   bool transferred = doConversion_ || !cNeedsConversion;
+
+   if ( transferred )
+   {
+      switch ( memoryRepresentation_ )
+      {
+         case Int8:
+            loadElements<int8_t>( p, stride_, values, count );
+            break;
+         case UInt8:
+            loadElements<uint8_t>( p, stride_, values, count );
+            break;
+         case Int16:
+            loadElements<int16_t>( p, stride_, values, count );
+            break;
+         case UInt16:
+            loadElements<uint16_t>( p, stride_, values, count );
+            break;
+         case Int32:
+            loadElements<int32_t>( p, stride_, values, count );
+            break;
+         case UInt32:
+            loadElements<uint32_t>( p, stride_, values, count );
+            break;
+         case Int64:
+            loadElements<int64_t>( p, stride_, values, count );
+            break;
+         case Bool:
+            loadElements<bool>( p, stride_, values, count );
+            break;
+         case Real32:
+            loadElements<float>( p, stride_, values, count );
+            break;
+         case Real64:
+            /// Check that exponent of user's value is not too large for single precision
+            if ( std::is_same<T, float>::value &&
+                 !allWithin<double>( p, stride_, count, DOUBLE_MIN, DOUBLE_MAX ) )
+            {
+               transferred = false;
+               break;
+            }
+            loadElements<double>( p, stride_, values, count );
+            break;
+         default:
+            transferred = false;
+            break;
+      }
+   }
+
+   if ( transferred )
+   {
+      advance( count );
+      return;
+   }
+
+   for ( size_t i = 0; i < count; i++ )
+   {
+      values[i] = std::is_same<T, float>::value ? getNextFloat() : getNextDouble();
+   }
+}
+
+void SourceDestBufferImpl::getNextFloatBlock( float *values, size_t count )
+{
+   _getNextRealBlock( values, count );
+}
+
+void SourceDestBufferImpl::getNextDoubleBlock( double *values, size_t count )
+{
+   _getNextRealBlock( values, count );
+}
+
+void SourceDestBufferImpl::setNextInt64Block( const int64_t *values, size_t count )
+{
+   /// don't checkImageFileOpen
+
+   int64BlockStore( false, INT64_MIN, INT64_MAX, 0, 0 )( *this, values, count, 0, 0 );
+}
+
+void SourceDestBufferImpl::setNextInt64Block( const int64_t *values, size_t count, double scale,
+                                              double offset )
+{
+   /// don't checkImageFileOpen
+
+   int64BlockStore( true, INT64_MIN, INT64_MAX, scale, offset )( *this, values, count, scale,
+                                                                  offset );
+}
+
+SourceDestBufferImpl::Int64BlockStore SourceDestBufferImpl::int64BlockStore(
+   bool scaled, int64_t minimum, int64_t maximum, double scale, double offset ) const
+{
+   /// If the user did not request scaling, then we send raw values to user's buffer.
+   scaled = scaled && doScaling_;
+
+   switch ( memoryRepresentation_ )
+   {
+      case Int8:
+         return selectInt64BlockStore<int8_t>( scaled, minimum, maximum, scale, offset );
+      case UInt8:
+         return selectInt64BlockStore<uint8_t>( scaled, minimum, maximum, scale, offset );
+      case Int16:
+         return selectInt64BlockStore<int16_t>( scaled, minimum, maximum, scale, offset );
+      case UInt16:
+         return selectInt64BlockStore<uint16_t>( scaled, minimum, maximum, scale, offset );
+      case Int32:
+         return selectInt64BlockStore<int32_t>( scaled, minimum, maximum, scale, offset );
+      case UInt32:
+         return selectInt64BlockStore<uint32_t>( scaled, minimum, maximum, scale, offset );
+      case Int64:
+         return selectInt64BlockStore<int64_t>( scaled, minimum, maximum, scale, offset );
+      case Real32:
+         if ( doConversion_ )
+         {
+            return selectInt64BlockStore<float>( scaled, minimum, maximum, scale, offset );
+         }
+         break;
+      case Real64:
+         if ( doConversion_ )
+         {
+            return selectInt64BlockStore<double>( scaled, minimum, maximum, scale, offset );
+         }
+         break;
+      default:
+         break;
+   }
+
+   /// Bool buffers and missing conversions are handled (or reported) by the single element
+   /// version.
+   return scaled ? storeInt64Each<true> : storeInt64Each<false>;
+}
+
+template <typename DestT>
+SourceDestBufferImpl::Int64BlockStore SourceDestBufferImpl::selectInt64BlockStore(
+   bool scaled, int64_t minimum, int64_t maximum, double scale, double offset )
+{
+   using IsIntegral = typename std::is_integral<DestT>::type;
+
+   /// Only check the values if some value in [minimum, maximum] would not fit
+   if ( scaled )
+   {
+      return scaledRangeFits<DestT>( minimum, maximum, scale, offset )
+                ? storeInt64Block<DestT, true, false>
+                : storeInt64Block<DestT, true, true>;
+   }
+
+   return ( fits<DestT>( minimum, IsIntegral() ) && fits<DestT>( maximum, IsIntegral() ) )
+             ? storeInt64Block<DestT, false, false>
+             : storeInt64Block<DestT, false, true>;
+}
+
+template <typename DestT, bool Scaled, bool Checked>
+void SourceDestBufferImpl::storeInt64Block( SourceDestBufferImpl &buffer, const int64_t *values,
+                                            size_t count, double scale, double offset )
+{
+   using IsIntegral = typename std::is_integral<DestT>::type;
+
+   char *p = buffer.nextElements( count );
+
+   /// If any value doesn't fit, let the single element version report it
+   if ( Checked && !( Scaled ? allScaledFit<DestT>( values, count, scale, offset )
+                             : allFit<DestT>( values, count, IsIntegral() ) ) )
+   {
+      storeInt64Each<Scaled>( buffer, values, count, scale, offset );
+      return;
+   }
+
+   if ( Scaled )
+   {
+      storeScaledElements<DestT>( p, buffer.stride_, values, count, scale, offset );
+   }
+   else
+   {
+      storeElements<DestT>( p, buffer.stride_, values, count );
+   }
+
+   buffer.advance( count );
+}
+
+template <bool Scaled>
+void SourceDestBufferImpl::storeInt64Each( SourceDestBufferImpl &buffer, const int64_t *values,
+                                           size_t count, double scale, double offset )
+{
+   /// Verify have room for the whole block before storing any of it
+   buffer.nextElements( count );
+
+   for ( size_t i = 0; i < count; i++ )
+   {
+      if ( Scaled )
+      {
+         buffer.setNextInt64( values[i], scale, offset );
+      }
+      else
+      {
+         buffer.setNextInt64( values[i] );
+      }
+   }
+}
+
+template <typename T>
+void SourceDestBufferImpl::_setNextRealBlock( const T *values, size_t count )
+{
+   static_assert( std::is_same<T, double>::value || std::is_same<T, float>::value,
+                  "_setNextRealBlock() requires float or double type" );
+
+   /// don't checkImageFileOpen
+
+   /// Values of the buffer's own type are copied as they are
+   const MemoryRepresentation cNativeRepresentation =
+      std::is_same<T, float>::value ? Real32 : Real64;
+
+   if ( memoryRepresentation_ == cNativeRepresentation )
+   {
+      copyNextReals( reinterpret_cast<const char *>( values ), count );
+      return;
+   }
+
+   char *p = nextElements( count );
+
+   /// Values which don't fit, Bool buffers, and missing conversions are left to the single
+   /// element version.
+   bool transferred = false;
+
+   switch ( memoryRepresentation_ )
+   {
+      case Int8:
+         transferred = doConversion_ && storeRealsAsIntegers<int8_t>( p, stride_, values, count );
+         break;
+      case UInt8:
+         transferred = doConversion_ && storeRealsAsIntegers<uint8_t>( p, stride_, values, count );
+         break;
+      case Int16:
+         transferred = doConversion_ && storeRealsAsIntegers<int16_t>( p, stride_, values, count );
+         break;
+      case UInt16:
+         transferred =
+            doConversion_ && storeRealsAsIntegers<uint16_t>( p, stride_, values, count );
+         break;
+      case Int32:
+         transferred = doConversion_ && storeRealsAsIntegers<int32_t>( p, stride_, values, count );
+         break;
+      case UInt32:
+         transferred =
+            doConversion_ && storeRealsAsIntegers<uint32_t>( p, stride_, values, count );
+         break;
+      case Int64:
+         transferred = doConversion_ && storeRealsAsIntegers<int64_t>( p, stride_, values, count );
+         break;
+      case Real32:
+         /// Check for really large exponents that can't fit in a single precision
+         transferred =
+            storeRealsWithin<float>( p, stride_, values, count, DOUBLE_MIN, DOUBLE_MAX );
+         break;
+      case Real64:
+         storeElements<double>( p, stride_, values, count );
+         transferred = true;
+         break;
+      default:
+         break;
+   }
+
+   if ( transferred )
+   {
+      advance( count );
+      return;
+   }
+
+   for ( size_t i = 0; i < count; i++ )
+   {
+      _setNextReal( values[i] );
+   }
+}
+
+void SourceDestBufferImpl::setNextFloatBlock( const float *values, size_t count )
+{
+   _setNextRealBlock( values, count );
+}
+
+void SourceDestBufferImpl::setNextDoubleBlock( const double *values, size_t count )
+{
+   _setNextRealBlock( values, count );
+}
+
+char *SourceDestBufferImpl::nextElements( size_t count ) const
+{
+   /// don't checkImageFileOpen
+
+   /// Verify have room.
+   if ( count > capacity_ - nextIndex_ )
+   {
+      throw E57_EXCEPTION2( ErrorInternal, "pathName=" + pathName_ +
+                                              " count=" + toString( count ) );
+   }
+
+   return &base_[nextIndex_ * stride_];
+}
+
+void SourceDestBufferImpl::copyNextReals( const char *source, size_t count )
+{
+   /// don't checkImageFileOpen
+
+   size_t elementSize = 0;
+
+   switch ( memoryRepresentation_ )
+   {
+      case Real32:
+         elementSize = sizeof( float );
+         break;
+      case Real64:
+         elementSize = sizeof( double );
+         break;
+      default:
+         throw E57_EXCEPTION2( ErrorInternal, "pathName=" + pathName_ );
+   }
+
+   char *p = nextElements( count );
+
+   /// The values already have the buffer's layout, so copy them as they are. Packed buffers take
+   /// a single copy.
+   if ( stride_ == elementSize )
+   {
+      std::memcpy( p, source, count * elementSize );
+   }
+   else
+   {
+      for ( size_t i = 0; i < count; i++ )
+      {
+         std::memcpy( p, source, elementSize );
+
+         p += stride_;
+         source += elementSize;
+      }
+   }
+
+   advance( count );
+}
+
 void SourceDestBufferImpl::setNextString( const ustring &value )
 {
    /// don't checkImageFileOpen
@@ -1054,6 +1802,7 @@ void SourceDestBufferImpl::dump( int indent, std::ostream &os )
    os << space( indent ) << "ustrings:             " << static_cast<const void *>( ustrings_ )
       << std::endl;
    os << space( indent ) << "capacity:             " << capacity_ << std::endl;
+   os << space( indent ) << "limit:                " << limit_ << std::endl;
    os << space( indent ) << "doConversion:         " << doConversion_ << std::endl;
    os << space( indent ) << "doScaling:            " << doScaling_ << std::endl;
    os << space( indent ) << "stride:               " << stride_ << std::endl;
@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "Common.h"
 
 namespace e57
@@ -89,6 +91,12 @@ namespace e57
          return capacity_;
       }
 
+      /// Number of elements which can be transferred before the buffer counts as full
+      size_t limit() const
+      {
+         return limit_;
+      }
+
       unsigned nextIndex() const
       {
          return nextIndex_;
@@ -97,6 +105,14 @@ namespace e57
       void rewind()
       {
          nextIndex_ = 0;
+         limit_ = capacity_;
+      }
+
+      /// Rewind, and count the buffer as full once @a limit elements have been transferred
+      void rewind( size_t limit )
+      {
+         nextIndex_ = 0;
+         limit_ = std::min( limit, capacity_ );
       }
 
       int64_t getNextInt64();
@@ -110,6 +126,37 @@ namespace e57
       void setNextDouble( double value );
       void setNextString( const ustring &value );
 
+      /// Block versions of the functions above: transfer @a count elements in one call. Values
+      /// are converted, scaled, and range checked just as the single element functions would do
+      /// it (and the same error is reported for the same element), but the buffer's type is only
+      /// looked at once per block. If an error is thrown by a get function, the contents of
+      /// @a values from the element which failed on are unspecified.
+      void getNextInt64Block( int64_t *values, size_t count );
+      void getNextInt64Block( int64_t *values, size_t count, double scale, double offset );
+      void getNextFloatBlock( float *values, size_t count );
+      void getNextDoubleBlock( double *values, size_t count );
+      void setNextInt64Block( const int64_t *values, size_t count );
+      void setNextInt64Block( const int64_t *values, size_t count, double scale, double offset );
+      void setNextFloatBlock( const float *values, size_t count );
+      void setNextDoubleBlock( const double *values, size_t count );
+
+      /// Copy @a count values straight into a Real32 (floats) or Real64 (doubles) buffer. The
+      /// values at @a source must have the buffer's representation, but need not be aligned.
+      void copyNextReals( const char *source, size_t count );
+
+      /// Stores a block of values as setNextInt64Block() does (@a scale and @a offset are only
+      /// used for scaled values)
+      using Int64BlockStore = void ( * )( SourceDestBufferImpl &buffer, const int64_t *values,
+                                           size_t count, double scale, double offset );
+
+      /// Pick the function which stores blocks of values in [@a minimum, @a maximum], scaled by
+      /// @a scale and @a offset if @a scaled. Its loop is specialized for the buffer's type, and
+      /// it only checks the values if some value in the range would not fit, so a caller storing
+      /// many blocks (e.g. a decoder) can pick it once. It must be called with the same scale and
+      /// offset.
+      Int64BlockStore int64BlockStore( bool scaled, int64_t minimum, int64_t maximum, double scale,
+                                       double offset ) const;
+
       void checkCompatible( const std::shared_ptr<SourceDestBufferImpl> &newBuf ) const;
 
 #ifdef E57_ENABLE_DIAGNOSTIC_OUTPUT
@@ -118,6 +165,26 @@ namespace e57
 
    private:
       template <typename T> void _setNextReal( T inValue );
+      template <typename T> void _getNextRealBlock( T *values, size_t count );
+      template <typename T> void _setNextRealBlock( const T *values, size_t count );
+
+      template <typename DestT>
+      static Int64BlockStore selectInt64BlockStore( bool scaled, int64_t minimum, int64_t maximum,
+                                                    double scale, double offset );
+      template <typename DestT, bool Scaled, bool Checked>
+      static void storeInt64Block( SourceDestBufferImpl &buffer, const int64_t *values,
+                                   size_t count, double scale, double offset );
+      template <bool Scaled>
+      static void storeInt64Each( SourceDestBufferImpl &buffer, const int64_t *values,
+                                  size_t count, double scale, double offset );
+
+      /// Check there is room for @a count more elements and return the address of the next one.
+      /// Elements transferred there directly are counted with advance().
+      char *nextElements( size_t count ) const;
+      void advance( size_t count )
+      {
+         nextIndex_ += static_cast<unsigned>( count );
+      }
 
       /// Common routine to check that constructor arguments were ok, throws if not
       void checkState_() const;
@@ -136,6 +203,9 @@ namespace e57
       /// Total number of elements in array
       size_t capacity_ = 0;
 
+      /// Number of elements to transfer until the next rewind(), at most capacity_
+      size_t limit_ = 0;
+
       /// Convert memory representation to/from disk representation
       bool doConversion_ = false;
 
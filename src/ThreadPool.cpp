@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: BSL-1.0
+// Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+
+#include "ThreadPool.h"
+
+namespace e57
+{
+   ThreadPool::ThreadPool( unsigned threadCount )
+   {
+      for ( unsigned i = 1; i < threadCount; ++i )
+      {
+         workers_.emplace_back( &ThreadPool::workerLoop, this );
+      }
+   }
+
+   ThreadPool::~ThreadPool()
+   {
+      {
+         std::lock_guard<std::mutex> lock( mutex_ );
+
+         stop_ = true;
+      }
+
+      startCondition_.notify_all();
+
+      for ( auto &worker : workers_ )
+      {
+         worker.join();
+      }
+   }
+
+   unsigned ThreadPool::threadCount() const
+   {
+      return static_cast<unsigned>( workers_.size() ) + 1;
+   }
+
+   void ThreadPool::run( size_t taskCount, const std::function<void( size_t )> &task )
+   {
+      // Not worth waking anyone up
+      if ( workers_.empty() || taskCount == 1 )
+      {
+         for ( size_t i = 0; i < taskCount; ++i )
+         {
+            task( i );
+         }
+
+         return;
+      }
+
+      std::unique_lock<std::mutex> lock( mutex_ );
+
+      task_ = &task;
+      taskCount_ = taskCount;
+      nextTask_ = 0;
+      error_ = nullptr;
+      ++generation_;
+
+      startCondition_.notify_all();
+
+      runTasks( lock );
+
+      doneCondition_.wait( lock,
+                           [this] { return ( nextTask_ >= taskCount_ ) && ( tasksRunning_ == 0 ); } );
+
+      task_ = nullptr;
+
+      if ( error_ )
+      {
+         std::exception_ptr error = error_;
+
+         error_ = nullptr;
+
+         std::rethrow_exception( error );
+      }
+   }
+
+   void ThreadPool::workerLoop()
+   {
+      uint64_t generation = 0;
+
+      std::unique_lock<std::mutex> lock( mutex_ );
+
+      while ( true )
+      {
+         startCondition_.wait( lock, [&] { return stop_ || ( generation_ != generation ); } );
+
+         if ( stop_ )
+         {
+            return;
+         }
+
+         generation = generation_;
+
+         runTasks( lock );
+      }
+   }
+
+   // Run tasks until there are none left to hand out. Called with the lock held.
+   void ThreadPool::runTasks( std::unique_lock<std::mutex> &lock )
+   {
+      while ( nextTask_ < taskCount_ )
+      {
+         const size_t cTaskIndex = nextTask_++;
+         const std::function<void( size_t )> *task = task_;
+
+         ++tasksRunning_;
+
+         lock.unlock();
+
+         std::exception_ptr error;
+
+         try
+         {
+            ( *task )( cTaskIndex );
+         }
+         catch ( ... )
+         {
+            error = std::current_exception();
+         }
+
+         lock.lock();
+
+         --tasksRunning_;
+
+         if ( error )
+         {
+            if ( !error_ )
+            {
+               error_ = error;
+            }
+
+            // Don't start any more
+            nextTask_ = taskCount_;
+         }
+      }
+
+      if ( tasksRunning_ == 0 )
+      {
+         doneCondition_.notify_all();
+      }
+   }
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: BSL-1.0
+// Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace e57
+{
+   /// @brief A small fixed-size pool of threads used to run independent tasks in parallel
+   /// @details run() blocks until every task has been run. The calling thread runs tasks too, so
+   /// a pool of N threads uses N - 1 worker threads. A pool of one thread runs everything on the
+   /// caller's thread.
+   class ThreadPool
+   {
+   public:
+      explicit ThreadPool( unsigned threadCount );
+      ~ThreadPool();
+
+      ThreadPool( const ThreadPool & ) = delete;
+      ThreadPool &operator=( const ThreadPool & ) = delete;
+
+      /// Number of threads running tasks, including the caller's.
+      unsigned threadCount() const;
+
+      /// Call task( i ) for each i in [0, taskCount) and wait for them all to finish.
+      /// If a task throws, tasks which haven't started are skipped and the exception is rethrown
+      /// here once the running ones have finished.
+      void run( size_t taskCount, const std::function<void( size_t )> &task );
+
+   private:
+      void workerLoop();
+      void runTasks( std::unique_lock<std::mutex> &lock );
+
+      std::vector<std::thread> workers_;
+
+      std::mutex mutex_; // protects the members below
+      std::condition_variable startCondition_;
+      std::condition_variable doneCondition_;
+      const std::function<void( size_t )> *task_ = nullptr;
+      size_t taskCount_ = 0;
+      size_t nextTask_ = 0;      // next task to hand out
+      size_t tasksRunning_ = 0;  // tasks handed out but not yet finished
+      uint64_t generation_ = 0;  // incremented by each run() so workers know there is new work
+      std::exception_ptr error_; // first exception thrown by a task
+      bool stop_ = false;
+   };
+}
@@ -126,7 +126,17 @@ namespace e57
    }
 
    WriterImpl::WriterImpl( const ustring &filePath, const WriterOptions &options ) :
-      imf_( filePath, "w" ), root_( imf_.root() ), data3D_( imf_, true ), images2D_( imf_, true )
+      WriterImpl( ImageFile( filePath, "w" ), options )
+   {
+   }
+
+   WriterImpl::WriterImpl( std::shared_ptr<IODevice> device, const WriterOptions &options ) :
+      WriterImpl( ImageFile( std::move( device ), "w" ), options )
+   {
+   }
+
+   WriterImpl::WriterImpl( const ImageFile &imf, const WriterOptions &options ) :
+      imf_( imf ), root_( imf_.root() ), data3D_( imf_, true ), images2D_( imf_, true )
    {
       // We are using the E57 v1.0 data format standard field names.
       // The standard field names are used without an extension prefix (in the default namespace).
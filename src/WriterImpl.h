@@ -37,6 +37,7 @@ namespace e57
    {
    public:
       WriterImpl( const ustring &filePath, const WriterOptions &options );
+      WriterImpl( std::shared_ptr<IODevice> device, const WriterOptions &options );
       ~WriterImpl();
 
       // disallow copying a WriterImpl
@@ -73,6 +74,8 @@ namespace e57
       ImageFile GetRawIMF();
 
    private:
+      WriterImpl( const ImageFile &imf, const WriterOptions &options );
+
       ImageFile imf_;
       StructureNode root_;
 
@@ -2,6 +2,8 @@
 // libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
 // SPDX-License-Identifier: BSL-1.0
 
+#include <vector>
+
 #include "E57SimpleData.h"
 
 // GoogleTest's ASSERT_NO_THROW() doesn't let us show any info about the exceptions.
@@ -33,4 +35,7 @@ namespace TestHelper
 {
    // Checks that the E57 file header has the expected values
    void CheckFileHeader( const e57::E57Root &fileHeader );
+
+   // Returns size bytes of random data (the same bytes every time)
+   std::vector<char> randomBytes( size_t size );
 }
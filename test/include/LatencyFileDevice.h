@@ -0,0 +1,49 @@
+#pragma once
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: BSL-1.0
+
+#include <chrono>
+#include <fstream>
+
+#include "E57Format.h"
+
+// An IODevice which serves a local file, sleeping before every read & write to simulate a slow
+// source (network, object store, etc.). It counts the calls so tests can see how many round trips
+// the library makes.
+class LatencyFileDevice : public e57::IODevice
+{
+public:
+   enum Mode
+   {
+      Read,
+      Write // create or truncate the file
+   };
+
+   LatencyFileDevice( const e57::ustring &filePath, Mode mode,
+                      std::chrono::microseconds latency = std::chrono::microseconds( 0 ) );
+
+   int64_t readAt( uint64_t offset, char *buffer, size_t count ) override;
+   int64_t writeAt( uint64_t offset, const char *buffer, size_t count ) override;
+   uint64_t size() const override;
+   bool resize( uint64_t newSize ) override;
+
+   uint64_t readCount() const
+   {
+      return readCount_;
+   }
+
+   uint64_t writeCount() const
+   {
+      return writeCount_;
+   }
+
+private:
+   e57::ustring filePath_;
+   std::chrono::microseconds latency_;
+
+   std::fstream stream_;
+   uint64_t size_ = 0;
+
+   uint64_t readCount_ = 0;
+   uint64_t writeCount_ = 0;
+};
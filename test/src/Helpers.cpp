@@ -1,3 +1,5 @@
+#include <random>
+
 #include "gtest/gtest.h"
 
 #include "Helpers.h"
@@ -13,4 +15,19 @@ namespace TestHelper
       EXPECT_EQ( fileHeader.versionMajor, 1 );
       EXPECT_EQ( fileHeader.versionMinor, 0 );
    }
+
+   std::vector<char> randomBytes( size_t size )
+   {
+      std::mt19937 generator( 42 );
+      std::uniform_int_distribution<int> distribution( 0, 255 );
+
+      std::vector<char> bytes( size );
+
+      for ( auto &byte : bytes )
+      {
+         byte = static_cast<char>( distribution( generator ) );
+      }
+
+      return bytes;
+   }
 }
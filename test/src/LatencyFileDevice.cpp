@@ -0,0 +1,118 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: BSL-1.0
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "LatencyFileDevice.h"
+
+LatencyFileDevice::LatencyFileDevice( const e57::ustring &filePath, Mode mode,
+                                      std::chrono::microseconds latency ) :
+   filePath_( filePath ), latency_( latency )
+{
+   if ( mode == Write )
+   {
+      stream_.open( filePath_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc );
+   }
+   else
+   {
+      stream_.open( filePath_, std::ios::in | std::ios::binary );
+   }
+
+   if ( stream_.is_open() )
+   {
+      stream_.seekg( 0, std::ios::end );
+      size_ = static_cast<uint64_t>( stream_.tellg() );
+   }
+}
+
+int64_t LatencyFileDevice::readAt( uint64_t offset, char *buffer, size_t count )
+{
+   ++readCount_;
+
+   std::this_thread::sleep_for( latency_ );
+
+   if ( !stream_.is_open() || ( offset >= size_ ) )
+   {
+      return -1;
+   }
+
+   const auto cCount = static_cast<std::streamsize>( std::min<uint64_t>( count, size_ - offset ) );
+
+   stream_.clear();
+   stream_.seekg( static_cast<std::streamoff>( offset ) );
+   stream_.read( buffer, cCount );
+
+   return stream_ ? cCount : -1;
+}
+
+int64_t LatencyFileDevice::writeAt( uint64_t offset, const char *buffer, size_t count )
+{
+   ++writeCount_;
+
+   std::this_thread::sleep_for( latency_ );
+
+   // Fill any gap with zeros so that the stream can seek to offset
+   if ( ( offset > size_ ) && !resize( offset ) )
+   {
+      return -1;
+   }
+
+   stream_.clear();
+   stream_.seekp( static_cast<std::streamoff>( offset ) );
+   stream_.write( buffer, static_cast<std::streamsize>( count ) );
+   stream_.flush();
+
+   if ( !stream_ )
+   {
+      return -1;
+   }
+
+   size_ = std::max<uint64_t>( size_, offset + count );
+
+   return static_cast<int64_t>( count );
+}
+
+uint64_t LatencyFileDevice::size() const
+{
+   return size_;
+}
+
+bool LatencyFileDevice::resize( uint64_t newSize )
+{
+   if ( newSize == 0 )
+   {
+      stream_.close();
+      stream_.open( filePath_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc );
+
+      size_ = 0;
+
+      return stream_.is_open();
+   }
+
+   // std::fstream can't shrink a file
+   if ( newSize < size_ )
+   {
+      return false;
+   }
+
+   const std::vector<char> zeros( 64 * 1024, 0 );
+
+   stream_.clear();
+   stream_.seekp( static_cast<std::streamoff>( size_ ) );
+
+   while ( size_ < newSize )
+   {
+      const auto cCount =
+         static_cast<size_t>( std::min<uint64_t>( zeros.size(), newSize - size_ ) );
+
+      stream_.write( zeros.data(), static_cast<std::streamsize>( cCount ) );
+
+      size_ += cCount;
+   }
+
+   stream_.flush();
+
+   return static_cast<bool>( stream_ );
+}
@@ -0,0 +1,60 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: BSL-1.0
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitUnpack.h"
+#include "Helpers.h"
+
+namespace
+{
+   // Extract a value one bit at a time
+   uint64_t referenceValue( const std::vector<char> &bytes, size_t firstBit, unsigned bits )
+   {
+      uint64_t value = 0;
+
+      for ( unsigned i = 0; i < bits; ++i )
+      {
+         const size_t cBit = firstBit + i;
+         const auto cByte = static_cast<uint8_t>( bytes[cBit / 8] );
+
+         value |= static_cast<uint64_t>( ( cByte >> ( cBit % 8 ) ) & 1 ) << i;
+      }
+
+      return value;
+   }
+}
+
+TEST( BitUnpack, MatchesReferenceForAllWidths )
+{
+   for ( unsigned bits = 1; bits <= 64; ++bits )
+   {
+      for ( size_t firstBit = 0; firstBit < 16; firstBit += 3 )
+      {
+         for ( size_t count : { 0, 1, 7, 8, 9, 31, 100 } )
+         {
+            // Exactly the bytes needed, so reading past the end is caught by sanitizers
+            const auto cBytes = TestHelper::randomBytes( ( firstBit + count * bits + 7 ) / 8 );
+
+            std::vector<uint64_t> values( count );
+            std::vector<uint64_t> scalarValues( count );
+
+            e57::unpackBits( cBytes.data(), cBytes.size(), firstBit, bits, count, values.data() );
+            e57::unpackBitsScalar( cBytes.data(), cBytes.size(), firstBit, bits, count,
+                                   scalarValues.data() );
+
+            for ( size_t i = 0; i < count; ++i )
+            {
+               const uint64_t cExpected = referenceValue( cBytes, firstBit + i * bits, bits );
+
+               ASSERT_EQ( values[i], cExpected )
+                  << "bits=" << bits << " firstBit=" << firstBit << " i=" << i;
+               ASSERT_EQ( scalarValues[i], cExpected )
+                  << "bits=" << bits << " firstBit=" << firstBit << " i=" << i;
+            }
+         }
+      }
+   }
+}
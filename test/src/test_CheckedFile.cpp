@@ -0,0 +1,652 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: BSL-1.0
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "CheckedFile.h"
+#include "E57Exception.h"
+#include "Helpers.h"
+#include "IoUring.h"
+#include "LatencyFileDevice.h"
+
+namespace
+{
+   constexpr size_t cNumPages = 16;
+   constexpr size_t cLogicalSize = cNumPages * e57::CheckedFile::logicalPageSize;
+
+   // Write a file of cNumPages pages using CheckedFile and return its physical contents
+   std::vector<char> checkedFileContents()
+   {
+      const e57::ustring cFileName = "./CheckedFile.bin";
+
+      std::vector<char> data( cLogicalSize );
+
+      for ( size_t i = 0; i < data.size(); ++i )
+      {
+         data[i] = static_cast<char>( i * 7 );
+      }
+
+      {
+         e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+         file.write( data.data(), data.size() );
+         file.close();
+      }
+
+      std::ifstream stream( cFileName, std::ios::binary );
+
+      return { std::istreambuf_iterator<char>( stream ), std::istreambuf_iterator<char>() };
+   }
+
+   // Open a file written with CheckedFile and check that it holds data, padded with zeros to a
+   // whole page, and that the checksum of every page is valid
+   void checkFileContents( const e57::ustring &fileName, const std::vector<char> &data )
+   {
+      constexpr size_t cPageSize = e57::CheckedFile::logicalPageSize;
+      const size_t cPages = ( data.size() + cPageSize - 1 ) / cPageSize;
+
+      e57::CheckedFile file( fileName, e57::CheckedFile::Read, e57::ChecksumAll );
+
+      ASSERT_EQ( file.length( e57::CheckedFile::Physical ),
+                 cPages * e57::CheckedFile::physicalPageSize );
+      ASSERT_EQ( file.length(), cPages * e57::CheckedFile::logicalPageSize );
+
+      std::vector<char> buffer( file.length() );
+
+      E57_ASSERT_NO_THROW( file.readAt( 0, buffer.data(), buffer.size() ) );
+
+      EXPECT_TRUE( std::equal( data.begin(), data.end(), buffer.begin() ) );
+      EXPECT_TRUE( std::all_of( buffer.begin() + data.size(), buffer.end(),
+                                []( char c ) { return c == 0; } ) );
+
+      EXPECT_EQ( file.statistics().pagesVerified, cPages );
+
+      E57_ASSERT_NO_THROW( file.close() );
+   }
+}
+
+TEST( CheckedFile, BackgroundChecksumGoodFile )
+{
+   const auto contents = checkedFileContents();
+
+   ASSERT_EQ( contents.size(), cNumPages * e57::CheckedFile::physicalPageSize );
+
+   e57::CheckedFile file( contents.data(), contents.size(), e57::ChecksumBackground );
+
+   std::vector<char> buffer( cLogicalSize );
+
+   E57_ASSERT_NO_THROW( file.readAt( 0, buffer.data(), buffer.size() ) );
+   E57_ASSERT_NO_THROW( file.readAt( 0, buffer.data(), buffer.size() ) );
+   E57_ASSERT_NO_THROW( file.close() );
+}
+
+TEST( CheckedFile, BackgroundChecksumReportsBadPage )
+{
+   auto contents = checkedFileContents();
+
+   // Corrupt one byte of data in page 5
+   contents[5 * e57::CheckedFile::physicalPageSize + 100] ^= 0x01;
+
+   {
+      // Verifying in the foreground fails immediately...
+      e57::CheckedFile file( contents.data(), contents.size(), e57::ChecksumAll );
+
+      std::vector<char> buffer( cLogicalSize );
+
+      E57_ASSERT_THROW( file.readAt( 0, buffer.data(), buffer.size() ) );
+   }
+
+   {
+      // ... but in the background the data is returned and the failure is reported on close
+      e57::CheckedFile file( contents.data(), contents.size(), e57::ChecksumBackground );
+
+      std::vector<char> buffer( cLogicalSize );
+
+      E57_ASSERT_NO_THROW( file.readAt( 0, buffer.data(), buffer.size() ) );
+
+      try
+      {
+         file.close();
+
+         FAIL() << "close() did not report the bad checksum";
+      }
+      catch ( const e57::E57Exception &e )
+      {
+         EXPECT_EQ( e.errorCode(), e57::ErrorBadChecksum );
+      }
+   }
+}
+
+TEST( CheckedFile, ReadInPlace )
+{
+   auto contents = checkedFileContents();
+
+   e57::CheckedFile file( contents.data(), contents.size(), e57::ChecksumAll );
+
+   // Within the second page: points straight into the buffer
+   const uint64_t cOffset = e57::CheckedFile::logicalPageSize + 10;
+   const char *bytes = file.readInPlace( cOffset, 100 );
+
+   ASSERT_EQ( bytes, contents.data() + e57::CheckedFile::physicalPageSize + 10 );
+   EXPECT_EQ( bytes[0], static_cast<char>( cOffset * 7 ) );
+
+   // Crossing into the third page: not contiguous
+   EXPECT_EQ( file.readInPlace( cOffset, e57::CheckedFile::logicalPageSize ), nullptr );
+
+   // The page is still verified
+   contents[5 * e57::CheckedFile::physicalPageSize + 100] ^= 0x01;
+
+   E57_ASSERT_THROW( file.readInPlace( 5 * e57::CheckedFile::logicalPageSize, 4 ) );
+}
+
+TEST( CheckedFile, Statistics )
+{
+   const auto contents = checkedFileContents();
+
+   e57::CheckedFile file( contents.data(), contents.size(), e57::ChecksumAll );
+
+   std::vector<char> buffer( cLogicalSize );
+
+   file.readAt( 0, buffer.data(), buffer.size() );
+
+   e57::IOStatistics stats = file.statistics();
+
+   EXPECT_EQ( stats.pagesRead, cNumPages );
+   EXPECT_EQ( stats.pagesVerified, cNumPages );
+   EXPECT_EQ( stats.pagesNotVerified, 0u );
+   EXPECT_EQ( stats.bytesCopied, cLogicalSize );
+
+   // Reading it again doesn't verify anything
+   file.readAt( 0, buffer.data(), buffer.size() );
+
+   stats = file.statistics();
+
+   EXPECT_EQ( stats.pagesRead, 2 * cNumPages );
+   EXPECT_EQ( stats.pagesVerified, cNumPages );
+   EXPECT_EQ( stats.pagesNotVerified, cNumPages );
+   EXPECT_EQ( stats.bytesCopied, 2 * cLogicalSize );
+
+   // Nothing was read from the OS
+   EXPECT_EQ( stats.readCalls, 0u );
+}
+
+TEST( CheckedFile, Prefetch )
+{
+   const e57::ustring cFileName = "./CheckedFile-prefetch.bin";
+   constexpr size_t cPages = 1000;
+
+   std::vector<char> data( cPages * e57::CheckedFile::logicalPageSize );
+
+   for ( size_t i = 0; i < data.size(); ++i )
+   {
+      data[i] = static_cast<char>( i * 13 );
+   }
+
+   {
+      e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      file.write( data.data(), data.size() );
+      file.close();
+   }
+
+   // Read it from a slow device, prefetching ahead of each read
+   auto device = std::make_shared<LatencyFileDevice>( cFileName, LatencyFileDevice::Read,
+                                                      std::chrono::microseconds( 50 ) );
+
+   e57::CheckedFile file( device, e57::CheckedFile::Read, e57::ChecksumAll );
+
+   std::vector<char> buffer( 60000 );
+
+   for ( size_t offset = 0; offset < data.size(); offset += buffer.size() )
+   {
+      const size_t cCount = std::min( buffer.size(), data.size() - offset );
+
+      file.prefetch( offset, 4 * buffer.size() );
+      file.readAt( offset, buffer.data(), cCount );
+
+      ASSERT_TRUE( std::equal( buffer.begin(), buffer.begin() + cCount, data.begin() + offset ) )
+         << "offset=" << offset;
+   }
+
+   const e57::IOStatistics cStats = file.statistics();
+
+   EXPECT_EQ( cStats.pagesVerified, cPages );
+   EXPECT_GT( cStats.readCalls, 0u );
+
+   E57_ASSERT_NO_THROW( file.close() );
+}
+
+TEST( CheckedFile, PrefetchPartlyMissing )
+{
+   const e57::ustring cFileName = "./CheckedFile-prefetch-partly-missing.bin";
+   constexpr size_t cPages = 200;
+
+   std::vector<char> data( cPages * e57::CheckedFile::logicalPageSize );
+
+   for ( size_t i = 0; i < data.size(); ++i )
+   {
+      data[i] = static_cast<char>( i * 13 );
+   }
+
+   {
+      e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      file.write( data.data(), data.size() );
+      file.close();
+   }
+
+   auto device = std::make_shared<LatencyFileDevice>( cFileName, LatencyFileDevice::Read,
+                                                      std::chrono::microseconds( 50 ) );
+
+   e57::CheckedFile file( device, e57::CheckedFile::Read, e57::ChecksumAll );
+
+   // Only prefetch the first chunk (64 pages), then read past it. The first chunk is copied out
+   // of the prefetch slot, but the rest isn't there, so the whole run is read again.
+   constexpr size_t cReadSize = 100 * e57::CheckedFile::logicalPageSize;
+
+   std::vector<char> buffer( cReadSize );
+
+   file.prefetch( 0, 1 );
+   file.readAt( 0, buffer.data(), cReadSize );
+
+   ASSERT_TRUE( std::equal( buffer.begin(), buffer.end(), data.begin() ) );
+
+   // Only the copy to our buffer counts: the copy out of the prefetch slot was thrown away
+   const e57::IOStatistics cStats = file.statistics();
+
+   EXPECT_EQ( cStats.bytesCopied, cReadSize );
+
+   E57_ASSERT_NO_THROW( file.close() );
+}
+
+TEST( CheckedFile, PrefetchConcurrentReaders )
+{
+   const e57::ustring cFileName = "./CheckedFile-prefetch-concurrent.bin";
+   constexpr size_t cThreads = 4;
+   constexpr size_t cPagesPerThread = 1000;
+
+   std::vector<char> data( cThreads * cPagesPerThread * e57::CheckedFile::logicalPageSize );
+
+   for ( size_t i = 0; i < data.size(); ++i )
+   {
+      data[i] = static_cast<char>( i * 13 );
+   }
+
+   {
+      e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      file.write( data.data(), data.size() );
+      file.close();
+   }
+
+   // Each thread prefetches and reads its own part of the file, so the threads keep taking
+   // prefetch slots from each other. Without checksums, a page which was never copied out of
+   // a slot would go unnoticed except by comparing the data.
+   auto device = std::make_shared<LatencyFileDevice>( cFileName, LatencyFileDevice::Read,
+                                                      std::chrono::microseconds( 50 ) );
+
+   e57::CheckedFile file( device, e57::CheckedFile::Read, e57::ChecksumNone );
+
+   const size_t cPartSize = data.size() / cThreads;
+
+   std::vector<size_t> mismatches( cThreads, 0 );
+   std::vector<std::thread> threads;
+
+   for ( size_t t = 0; t < cThreads; ++t )
+   {
+      threads.emplace_back( [&, t] {
+         std::vector<char> buffer( 60000 );
+
+         for ( size_t offset = t * cPartSize; offset < ( t + 1 ) * cPartSize;
+               offset += buffer.size() )
+         {
+            const size_t cCount = std::min( buffer.size(), ( t + 1 ) * cPartSize - offset );
+
+            file.prefetch( offset, 5 * buffer.size() );
+            file.readAt( offset, buffer.data(), cCount );
+
+            if ( !std::equal( buffer.begin(), buffer.begin() + cCount, data.begin() + offset ) )
+            {
+               ++mismatches[t];
+            }
+         }
+      } );
+   }
+
+   for ( auto &thread : threads )
+   {
+      thread.join();
+   }
+
+   for ( size_t t = 0; t < cThreads; ++t )
+   {
+      EXPECT_EQ( mismatches[t], 0u ) << "thread " << t;
+   }
+
+   E57_ASSERT_NO_THROW( file.close() );
+}
+
+TEST( CheckedFile, ReadUnalignedRanges )
+{
+   const e57::ustring cFileName = "./CheckedFile-read-ranges.bin";
+   constexpr size_t cPages = 40;
+
+   std::vector<char> data( cPages * e57::CheckedFile::logicalPageSize - 500 );
+
+   for ( size_t i = 0; i < data.size(); ++i )
+   {
+      data[i] = static_cast<char>( i * 17 );
+   }
+
+   {
+      e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      file.write( data.data(), data.size() );
+      file.close();
+   }
+
+   e57::CheckedFile file( cFileName, e57::CheckedFile::Read, e57::ChecksumAll );
+
+   // Ranges starting and ending part way through pages, covering one page up to all of them
+   const size_t cRanges[][2] = {
+      { 0, 1 },
+      { 3, e57::CheckedFile::logicalPageSize },
+      { e57::CheckedFile::logicalPageSize - 1, 2 },
+      { 1000, 5 * e57::CheckedFile::logicalPageSize + 333 },
+      { 7 * e57::CheckedFile::logicalPageSize + 1019, 20 * e57::CheckedFile::logicalPageSize },
+      { 77, data.size() - 177 },
+      { data.size() - 1, 1 },
+   };
+
+   std::vector<char> buffer( data.size() );
+
+   for ( const auto &range : cRanges )
+   {
+      const size_t cOffset = range[0];
+      const size_t cCount = range[1];
+
+      std::fill( buffer.begin(), buffer.end(), 0 );
+
+      E57_ASSERT_NO_THROW( file.readAt( cOffset, buffer.data(), cCount ) );
+
+      ASSERT_TRUE( std::equal( buffer.begin(), buffer.begin() + cCount, data.begin() + cOffset ) )
+         << "offset=" << cOffset << " count=" << cCount;
+   }
+
+   // The same through the file position
+   file.seek( 5000 );
+
+   E57_ASSERT_NO_THROW( file.read( buffer.data(), 3 * e57::CheckedFile::logicalPageSize ) );
+
+   EXPECT_TRUE( std::equal( buffer.begin(), buffer.begin() + 3 * e57::CheckedFile::logicalPageSize,
+                            data.begin() + 5000 ) );
+   EXPECT_EQ( file.position(), 5000 + 3 * e57::CheckedFile::logicalPageSize );
+
+   // Past the end of the file (the last page is padded with zeros to its full size)
+   EXPECT_EQ( file.length(), cPages * e57::CheckedFile::logicalPageSize );
+   E57_ASSERT_THROW( file.readAt( file.length() - 10, buffer.data(), 11 ) );
+
+   E57_ASSERT_NO_THROW( file.close() );
+}
+
+TEST( CheckedFile, WriteSmallUnalignedPieces )
+{
+   const e57::ustring cFileName = "./CheckedFile-write-pieces.bin";
+
+   // More than fits in the write buffer, ending part way through a page
+   std::vector<char> data( ( 2 * e57::CheckedFile::maxWritePages + 3 ) *
+                              e57::CheckedFile::logicalPageSize +
+                           555 );
+
+   for ( size_t i = 0; i < data.size(); ++i )
+   {
+      data[i] = static_cast<char>( i * 19 );
+   }
+
+   {
+      e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      // Sizes which put the ends of the writes at all sorts of places, including right before,
+      // on, and right after the checksum at the end of a page
+      const std::vector<size_t> cSizes = { 1, 7, 1019, 1020, 1021, 1, 3, 2048, 333, 4100 };
+      size_t i = 0;
+
+      for ( size_t offset = 0; offset < data.size(); ++i )
+      {
+         const size_t cCount = std::min( cSizes[i % cSizes.size()], data.size() - offset );
+
+         file.write( &data[offset], cCount );
+
+         offset += cCount;
+
+         ASSERT_EQ( file.position(), offset );
+         ASSERT_EQ( file.length(), offset );
+      }
+
+      E57_ASSERT_NO_THROW( file.close() );
+   }
+
+   checkFileContents( cFileName, data );
+}
+
+TEST( CheckedFile, RewriteAfterLaterWrites )
+{
+   const e57::ustring cFileName = "./CheckedFile-rewrite.bin";
+   constexpr size_t cHeaderSize = 48;
+
+   std::vector<char> data( ( e57::CheckedFile::maxWritePages + 10 ) *
+                              e57::CheckedFile::logicalPageSize +
+                           100 );
+
+   for ( size_t i = 0; i < data.size(); ++i )
+   {
+      data[i] = static_cast<char>( i * 23 );
+   }
+
+   {
+      e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      // Write a placeholder header, then enough data that its page has been written out
+      const std::vector<char> cPlaceholder( cHeaderSize, 0 );
+
+      file.write( cPlaceholder.data(), cPlaceholder.size() );
+      file.write( &data[cHeaderSize], data.size() - cHeaderSize );
+
+      // Rewrite the header, as ImageFile does when it is closed. The rest of the first page has
+      // to be read back from the disk.
+      file.seek( 0 );
+      file.write( data.data(), cHeaderSize );
+
+      // Change some bytes in a page which is still in the write buffer, then go on writing at
+      // the end
+      const size_t cBufferedOffset = data.size() - 2 * e57::CheckedFile::logicalPageSize;
+
+      for ( size_t i = 0; i < 100; ++i )
+      {
+         data[cBufferedOffset + i] = static_cast<char>( ~data[cBufferedOffset + i] );
+      }
+
+      file.seek( cBufferedOffset );
+      file.write( &data[cBufferedOffset], 100 );
+
+      const std::vector<char> cMore( 3000, 'x' );
+
+      file.seek( data.size() );
+      file.write( cMore.data(), cMore.size() );
+
+      data.insert( data.end(), cMore.begin(), cMore.end() );
+
+      // Read back what we wrote before closing
+      std::vector<char> buffer( data.size() );
+
+      E57_ASSERT_NO_THROW( file.readAt( 0, buffer.data(), buffer.size() ) );
+
+      EXPECT_EQ( buffer, data );
+
+      E57_ASSERT_NO_THROW( file.close() );
+   }
+
+   checkFileContents( cFileName, data );
+}
+
+TEST( CheckedFile, ExtendSparse )
+{
+   const e57::ustring cFileName = "./CheckedFile-extend.bin";
+   constexpr size_t cPageSize = e57::CheckedFile::logicalPageSize;
+
+   // Some data, then a range of zeros too big for the write buffer (so it is reserved without
+   // writing it), part of which is filled in later
+   std::vector<char> data( 3 * cPageSize + 10 );
+
+   for ( size_t i = 0; i < data.size(); ++i )
+   {
+      data[i] = static_cast<char>( i * 29 );
+   }
+
+   const size_t cExtendedLength = data.size() + 300 * cPageSize + 123;
+   const size_t cFillOffset = data.size() + 100 * cPageSize - 50;
+   const std::vector<char> cFill( 5 * cPageSize, 'f' );
+
+   {
+      e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      file.write( data.data(), data.size() );
+      file.extend( cExtendedLength );
+
+      EXPECT_EQ( file.length(), cExtendedLength );
+      EXPECT_EQ( file.position(), cExtendedLength );
+
+      file.seek( cFillOffset );
+      file.write( cFill.data(), cFill.size() );
+
+      E57_ASSERT_NO_THROW( file.close() );
+   }
+
+   data.resize( cExtendedLength, 0 );
+
+   std::copy( cFill.begin(), cFill.end(), data.begin() + cFillOffset );
+
+   checkFileContents( cFileName, data );
+}
+
+TEST( CheckedFile, VerifiedPagesDontHideBadPage )
+{
+   constexpr size_t cPageSize = e57::CheckedFile::logicalPageSize;
+
+   auto contents = checkedFileContents();
+
+   // Corrupt one byte of data in page 5
+   contents[5 * e57::CheckedFile::physicalPageSize + 100] ^= 0x01;
+
+   e57::CheckedFile file( contents.data(), contents.size(), e57::ChecksumAll );
+
+   std::vector<char> buffer( cLogicalSize );
+
+   // Verify the pages before it, twice: the second time nothing is verified
+   E57_ASSERT_NO_THROW( file.readAt( 0, buffer.data(), 5 * cPageSize ) );
+   E57_ASSERT_NO_THROW( file.readAt( 10, buffer.data(), 5 * cPageSize - 10 ) );
+
+   e57::IOStatistics stats = file.statistics();
+
+   EXPECT_EQ( stats.pagesVerified, 5u );
+   EXPECT_EQ( stats.pagesNotVerified, 5u );
+
+   // A read which starts in verified pages still checks the bad one...
+   E57_ASSERT_THROW( file.readAt( 3 * cPageSize, buffer.data(), 4 * cPageSize ) );
+
+   // ... which isn't marked as verified, so it fails every time
+   E57_ASSERT_THROW( file.readAt( 5 * cPageSize + 500, buffer.data(), 10 ) );
+   E57_ASSERT_THROW( file.readInPlace( 5 * cPageSize, 4 ) );
+
+   // The pages after it are fine
+   E57_ASSERT_NO_THROW( file.readAt( 6 * cPageSize, buffer.data(), 10 * cPageSize ) );
+}
+
+#ifdef E57_IO_URING
+TEST( CheckedFile, IoUringRoundTrip )
+{
+   // CheckedFile quietly uses regular I/O if the kernel can't do what it needs, so check here
+   // that these tests really go through io_uring.
+   if ( !e57::IoUring( 2 ).isValid() )
+   {
+      GTEST_SKIP() << "io_uring (with IORING_OP_READ & IORING_OP_WRITE) is not available";
+   }
+
+   const e57::ustring cFileName = "./CheckedFile-io_uring.bin";
+
+   // Several write-behind buffers and read-ahead chunks, ending part way through a page
+   constexpr size_t cPages = 5 * e57::CheckedFile::maxWritePages + 10;
+
+   std::vector<char> data( cPages * e57::CheckedFile::logicalPageSize - 123 );
+
+   for ( size_t i = 0; i < data.size(); ++i )
+   {
+      data[i] = static_cast<char>( i * 11 );
+   }
+
+   {
+      e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      // Odd sized writes so the buffers fill part way through a write
+      constexpr size_t cWriteSize = 70001;
+
+      for ( size_t offset = 0; offset < data.size(); offset += cWriteSize )
+      {
+         file.write( &data[offset], std::min( cWriteSize, data.size() - offset ) );
+      }
+
+      E57_ASSERT_NO_THROW( file.close() );
+   }
+
+   e57::CheckedFile file( cFileName, e57::CheckedFile::Read, e57::ChecksumAll );
+
+   ASSERT_EQ( file.length( e57::CheckedFile::Physical ),
+              cPages * e57::CheckedFile::physicalPageSize );
+
+   std::vector<char> buffer( 60000 );
+
+   // Sequentially, which reads ahead...
+   for ( size_t offset = 0; offset < data.size(); offset += buffer.size() )
+   {
+      const size_t cCount = std::min( buffer.size(), data.size() - offset );
+
+      file.readAt( offset, buffer.data(), cCount );
+
+      ASSERT_TRUE( std::equal( buffer.begin(), buffer.begin() + cCount, data.begin() + offset ) )
+         << "offset=" << offset;
+   }
+
+   // ... and backwards, which doesn't
+   for ( size_t fromEnd = buffer.size(); fromEnd <= data.size(); fromEnd += 3 * buffer.size() )
+   {
+      const size_t cOffset = data.size() - fromEnd;
+
+      file.readAt( cOffset, buffer.data(), buffer.size() );
+
+      ASSERT_TRUE( std::equal( buffer.begin(), buffer.end(), data.begin() + cOffset ) )
+         << "offset=" << cOffset;
+   }
+
+   // Backwards again, prefetching the part before each read. The chunks asked for by prefetch()
+   // and the ones read ahead of each read share the same slots.
+   for ( size_t fromEnd = buffer.size(); fromEnd <= data.size(); fromEnd += buffer.size() )
+   {
+      const size_t cOffset = data.size() - fromEnd;
+
+      file.prefetch( cOffset - std::min( cOffset, 4 * buffer.size() ), 4 * buffer.size() );
+      file.readAt( cOffset, buffer.data(), buffer.size() );
+
+      ASSERT_TRUE( std::equal( buffer.begin(), buffer.end(), data.begin() + cOffset ) )
+         << "offset=" << cOffset;
+   }
+
+   E57_ASSERT_NO_THROW( file.close() );
+}
+#endif
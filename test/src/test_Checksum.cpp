@@ -0,0 +1,91 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: BSL-1.0
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Checksum.h"
+#include "Helpers.h"
+
+namespace
+{
+   using CRCFunction = uint32_t ( * )( const char *buf, size_t size );
+
+   struct Kernel
+   {
+      const char *name;
+      CRCFunction function;
+   };
+
+   // The dispatched function plus each implementation this CPU can run
+   std::vector<Kernel> supportedKernels()
+   {
+      std::vector<Kernel> kernels{ { "crc32c", e57::crc32c } };
+
+#ifdef E57_CRC32C_X86_64
+      if ( e57::cpuHasSSE42() )
+      {
+         kernels.push_back( { "crc32cSSE42", e57::crc32cSSE42 } );
+      }
+
+      if ( e57::cpuHasSSE42PCLMUL() )
+      {
+         kernels.push_back( { "crc32cSSE42PCLMUL", e57::crc32cSSE42PCLMUL } );
+      }
+#endif
+
+      return kernels;
+   }
+}
+
+TEST( Checksum, CheckValue )
+{
+   // Standard CRC-32C check value
+   const std::string data = "123456789";
+
+   EXPECT_EQ( e57::crc32cTable( data.data(), data.size() ), 0xE3069283 );
+
+   for ( const auto &kernel : supportedKernels() )
+   {
+      EXPECT_EQ( kernel.function( data.data(), data.size() ), 0xE3069283 ) << kernel.name;
+   }
+}
+
+TEST( Checksum, MatchesTableForLogicalPage )
+{
+   // The size CheckedFile checksums: one 1020-byte logical page
+   const auto bytes = TestHelper::randomBytes( 1020 );
+   const std::vector<char> zeroes( 1020, 0 );
+
+   for ( const auto &kernel : supportedKernels() )
+   {
+      EXPECT_EQ( kernel.function( bytes.data(), bytes.size() ),
+                 e57::crc32cTable( bytes.data(), bytes.size() ) )
+         << kernel.name;
+
+      EXPECT_EQ( kernel.function( zeroes.data(), zeroes.size() ),
+                 e57::crc32cTable( zeroes.data(), zeroes.size() ) )
+         << kernel.name;
+   }
+}
+
+TEST( Checksum, MatchesTableForAllSizesAndAlignments )
+{
+   const auto bytes = TestHelper::randomBytes( 4096 + 8 );
+
+   for ( const auto &kernel : supportedKernels() )
+   {
+      for ( size_t offset = 0; offset < 8; ++offset )
+      {
+         for ( size_t size = 0; size <= 4096; ++size )
+         {
+            const char *buf = bytes.data() + offset;
+
+            ASSERT_EQ( kernel.function( buf, size ), e57::crc32cTable( buf, size ) )
+               << kernel.name << " offset: " << offset << " size: " << size;
+         }
+      }
+   }
+}
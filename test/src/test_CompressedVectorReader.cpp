@@ -0,0 +1,850 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: BSL-1.0
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "E57Format.h"
+
+#include "Helpers.h"
+
+namespace
+{
+   constexpr int64_t cNumRecords = 20000;
+   constexpr size_t cBufferSize = 1000;
+
+   // Values stored in each field of a record
+   float xValue( int64_t record )
+   {
+      return static_cast<float>( record ) * 0.5f;
+   }
+
+   int32_t intensityValue( int64_t record )
+   {
+      return static_cast<int32_t>( ( record * 7 ) % 1001 );
+   }
+
+   e57::ustring nameValue( int64_t record )
+   {
+      return "record " + std::to_string( record );
+   }
+
+   // Write a compressed vector with a float, an integer (10 bits), a constant integer, and a
+   // string field
+   void writeRecords( const e57::ustring &fileName, size_t numRecords = cNumRecords )
+   {
+      e57::ImageFile imf( fileName, "w" );
+
+      e57::StructureNode proto( imf );
+      proto.set( "x", e57::FloatNode( imf, 0.0, e57::PrecisionSingle ) );
+      proto.set( "intensity", e57::IntegerNode( imf, 0, 0, 1000 ) );
+      proto.set( "constant", e57::IntegerNode( imf, 3, 3, 3 ) );
+      proto.set( "name", e57::StringNode( imf ) );
+
+      e57::VectorNode codecs( imf, true );
+      e57::CompressedVectorNode cv( imf, proto, codecs );
+
+      imf.root().set( "points", cv );
+
+      std::vector<float> x( numRecords );
+      std::vector<int32_t> intensity( numRecords );
+      std::vector<int32_t> constant( numRecords, 3 );
+      std::vector<e57::ustring> name( numRecords );
+
+      for ( size_t i = 0; i < numRecords; ++i )
+      {
+         x[i] = xValue( i );
+         intensity[i] = intensityValue( i );
+         name[i] = nameValue( i );
+      }
+
+      std::vector<e57::SourceDestBuffer> sbufs{
+         { imf, "x", x.data(), numRecords, true },
+         { imf, "intensity", intensity.data(), numRecords, true },
+         { imf, "constant", constant.data(), numRecords, true },
+         { imf, "name", &name },
+      };
+
+      e57::CompressedVectorWriter writer = cv.writer( sbufs );
+
+      writer.write( numRecords );
+      writer.close();
+
+      imf.close();
+   }
+
+   // Read all the records on each of threadCount threads, each with its own reader, and return
+   // the number of right records each thread read. Thread t starts at record
+   // (t * numRecords / threadCount) and goes around to the start again, so the readers are in
+   // different parts of the file.
+   std::vector<int64_t> readOnThreads( e57::ImageFile &imf, size_t threadCount,
+                                       int64_t numRecords )
+   {
+      std::vector<int64_t> goodRecords( threadCount, 0 );
+      std::vector<std::thread> threads;
+
+      for ( size_t t = 0; t < threadCount; ++t )
+      {
+         threads.emplace_back( [&imf, &goodRecords, t, threadCount, numRecords] {
+            // An exception would terminate the program, so just leave the count short
+            try
+            {
+               e57::CompressedVectorNode cv( imf.root().get( "/points" ) );
+
+               std::vector<float> x( cBufferSize );
+               std::vector<int32_t> intensity( cBufferSize );
+               std::vector<e57::ustring> name( cBufferSize );
+
+               std::vector<e57::SourceDestBuffer> dbufs{
+                  { imf, "x", x.data(), cBufferSize, true },
+                  { imf, "intensity", intensity.data(), cBufferSize, true },
+                  { imf, "name", &name },
+               };
+
+               e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+               const int64_t cStart = static_cast<int64_t>( t ) * numRecords /
+                                      static_cast<int64_t>( threadCount );
+
+               // From cStart to the end, then from the first record up to cStart
+               const int64_t cRanges[2][2] = { { cStart, numRecords }, { 0, cStart } };
+
+               for ( const auto &range : cRanges )
+               {
+                  if ( range[0] == range[1] )
+                  {
+                     continue;
+                  }
+
+                  reader.seek( range[0] );
+
+                  int64_t record = range[0];
+
+                  while ( record < range[1] )
+                  {
+                     const unsigned cCount = reader.read();
+
+                     if ( cCount == 0 )
+                     {
+                        break;
+                     }
+
+                     for ( unsigned i = 0; ( i < cCount ) && ( record < range[1] );
+                           ++i, ++record )
+                     {
+                        if ( ( x[i] == xValue( record ) ) &&
+                             ( intensity[i] == intensityValue( record ) ) &&
+                             ( name[i] == nameValue( record ) ) )
+                        {
+                           ++goodRecords[t];
+                        }
+                     }
+                  }
+               }
+
+               reader.close();
+            }
+            catch ( const e57::E57Exception & )
+            {
+            }
+         } );
+      }
+
+      for ( auto &thread : threads )
+      {
+         thread.join();
+      }
+
+      return goodRecords;
+   }
+}
+
+TEST( CompressedVectorReader, Seek )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-seek.e57";
+
+   writeRecords( cFileName );
+
+   e57::ImageFile imf( cFileName, "r" );
+   e57::CompressedVectorNode cv( imf.root().get( "points" ) );
+
+   std::vector<float> x( cBufferSize );
+   std::vector<int32_t> intensity( cBufferSize );
+   std::vector<int32_t> constant( cBufferSize );
+   std::vector<e57::ustring> name( cBufferSize );
+
+   std::vector<e57::SourceDestBuffer> dbufs{
+      { imf, "x", x.data(), cBufferSize, true },
+      { imf, "intensity", intensity.data(), cBufferSize, true },
+      { imf, "constant", constant.data(), cBufferSize, true },
+      { imf, "name", &name },
+   };
+
+   e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+   // Forwards, backwards, to the start, and to the last record
+   const std::vector<int64_t> cRecords{ 12345, 777, 19999, 0, 5001, 5000, cNumRecords - 10 };
+
+   for ( const int64_t cRecord : cRecords )
+   {
+      reader.seek( cRecord );
+
+      const unsigned cCount = reader.read();
+
+      ASSERT_EQ( cCount, static_cast<unsigned>( std::min<int64_t>( cBufferSize,
+                                                                   cNumRecords - cRecord ) ) )
+         << "record=" << cRecord;
+
+      for ( unsigned i = 0; i < cCount; ++i )
+      {
+         ASSERT_EQ( x[i], xValue( cRecord + i ) ) << "record=" << cRecord + i;
+         ASSERT_EQ( intensity[i], intensityValue( cRecord + i ) ) << "record=" << cRecord + i;
+         ASSERT_EQ( constant[i], 3 ) << "record=" << cRecord + i;
+         ASSERT_EQ( name[i], nameValue( cRecord + i ) ) << "record=" << cRecord + i;
+      }
+   }
+
+   // Seeking to the end is allowed, but there is nothing to read
+   reader.seek( cNumRecords );
+
+   EXPECT_EQ( reader.read(), 0u );
+
+   // Seeking past the end is not
+   E57_ASSERT_THROW( reader.seek( cNumRecords + 1 ) );
+
+   reader.close();
+   imf.close();
+}
+
+TEST( CompressedVectorReader, ReadRange )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-range.e57";
+
+   writeRecords( cFileName );
+
+   e57::ImageFile imf( cFileName, "r" );
+   e57::CompressedVectorNode cv( imf.root().get( "points" ) );
+
+   std::vector<float> x( cBufferSize );
+   std::vector<int32_t> intensity( cBufferSize );
+   std::vector<e57::ustring> name( cBufferSize );
+
+   std::vector<e57::SourceDestBuffer> dbufs{
+      { imf, "x", x.data(), cBufferSize, true },
+      { imf, "intensity", intensity.data(), cBufferSize, true },
+      { imf, "name", &name },
+   };
+
+   e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+   const auto cCheckRange = [&]( int64_t startRecord, size_t count ) {
+      // Records past the range must be left alone
+      std::fill( x.begin(), x.end(), -1.0f );
+
+      const unsigned cCount = reader.read( static_cast<uint64_t>( startRecord ), count );
+
+      ASSERT_EQ( cCount, static_cast<unsigned>(
+                            std::min<int64_t>( static_cast<int64_t>( count ),
+                                               cNumRecords - startRecord ) ) )
+         << "startRecord=" << startRecord;
+
+      for ( unsigned i = 0; i < cCount; ++i )
+      {
+         ASSERT_EQ( x[i], xValue( startRecord + i ) ) << "record=" << startRecord + i;
+         ASSERT_EQ( intensity[i], intensityValue( startRecord + i ) )
+            << "record=" << startRecord + i;
+         ASSERT_EQ( name[i], nameValue( startRecord + i ) ) << "record=" << startRecord + i;
+      }
+
+      for ( size_t i = cCount; i < cBufferSize; ++i )
+      {
+         ASSERT_EQ( x[i], -1.0f ) << "index=" << i;
+      }
+   };
+
+   // Ranges which follow each other, then jumping backwards and forwards
+   cCheckRange( 0, 300 );
+   cCheckRange( 300, 77 );
+   cCheckRange( 377, cBufferSize );
+   cCheckRange( 55, 10 );
+   cCheckRange( 15000, 1 );
+
+   // A range running past the end is cut short
+   cCheckRange( cNumRecords - 20, 100 );
+
+   // read() carries on after a range
+   reader.read( 4000, 10 );
+
+   ASSERT_EQ( reader.read(), static_cast<unsigned>( cBufferSize ) );
+   EXPECT_EQ( x[0], xValue( 4010 ) );
+   EXPECT_EQ( name[cBufferSize - 1], nameValue( 4010 + cBufferSize - 1 ) );
+
+   // The range must fit in the buffers
+   E57_ASSERT_THROW( reader.read( 0, cBufferSize + 1 ) );
+   E57_ASSERT_THROW( reader.read( cNumRecords + 1, 1 ) );
+
+   reader.close();
+   imf.close();
+}
+
+TEST( CompressedVectorReader, FloatFields )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-float.e57";
+   constexpr size_t cFloatNumRecords = 50000;
+
+   const auto cSingleValue = []( size_t record ) { return static_cast<float>( record ) * 0.25f; };
+   const auto cDoubleValue = []( size_t record ) { return static_cast<double>( record ) / 3.0; };
+
+   {
+      e57::ImageFile imf( cFileName, "w" );
+
+      e57::StructureNode proto( imf );
+      proto.set( "single", e57::FloatNode( imf, 0.0, e57::PrecisionSingle ) );
+      proto.set( "double", e57::FloatNode( imf, 0.0, e57::PrecisionDouble ) );
+
+      e57::VectorNode codecs( imf, true );
+      e57::CompressedVectorNode cv( imf, proto, codecs );
+
+      imf.root().set( "points", cv );
+
+      std::vector<float> single( cFloatNumRecords );
+      std::vector<double> dbl( cFloatNumRecords );
+
+      for ( size_t i = 0; i < cFloatNumRecords; ++i )
+      {
+         single[i] = cSingleValue( i );
+         dbl[i] = cDoubleValue( i );
+      }
+
+      std::vector<e57::SourceDestBuffer> sbufs{
+         { imf, "single", single.data(), cFloatNumRecords, true },
+         { imf, "double", dbl.data(), cFloatNumRecords, true },
+      };
+
+      e57::CompressedVectorWriter writer = cv.writer( sbufs );
+
+      writer.write( cFloatNumRecords );
+      writer.close();
+
+      imf.close();
+   }
+
+   e57::ImageFile imf( cFileName, "r" );
+   e57::CompressedVectorNode cv( imf.root().get( "points" ) );
+
+   {
+      // Buffers of the same types as the fields, packed and interleaved
+      struct Point
+      {
+         double d;
+         float s;
+      };
+
+      std::vector<float> single( cFloatNumRecords );
+      std::vector<Point> points( cFloatNumRecords );
+
+      std::vector<e57::SourceDestBuffer> dbufs{
+         { imf, "single", single.data(), cFloatNumRecords, false },
+         { imf, "double", &points[0].d, cFloatNumRecords, false, false, sizeof( Point ) },
+      };
+
+      e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+      ASSERT_EQ( reader.read(), static_cast<unsigned>( cFloatNumRecords ) );
+
+      reader.close();
+
+      for ( size_t i = 0; i < cFloatNumRecords; ++i )
+      {
+         ASSERT_EQ( single[i], cSingleValue( i ) ) << "record=" << i;
+         ASSERT_EQ( points[i].d, cDoubleValue( i ) ) << "record=" << i;
+      }
+   }
+
+   {
+      // Buffers of the other precision
+      std::vector<double> single( cFloatNumRecords );
+      std::vector<float> dbl( cFloatNumRecords );
+
+      std::vector<e57::SourceDestBuffer> dbufs{
+         { imf, "single", single.data(), cFloatNumRecords, true },
+         { imf, "double", dbl.data(), cFloatNumRecords, true },
+      };
+
+      e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+      ASSERT_EQ( reader.read(), static_cast<unsigned>( cFloatNumRecords ) );
+
+      reader.close();
+
+      for ( size_t i = 0; i < cFloatNumRecords; ++i )
+      {
+         ASSERT_EQ( single[i], static_cast<double>( cSingleValue( i ) ) ) << "record=" << i;
+         ASSERT_EQ( dbl[i], static_cast<float>( cDoubleValue( i ) ) ) << "record=" << i;
+      }
+   }
+
+   imf.close();
+}
+
+TEST( CompressedVectorReader, IntegerBufferTypes )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-integer-types.e57";
+   constexpr size_t cIntNumRecords = 5000;
+
+   const auto cIntValue = []( size_t record ) {
+      return static_cast<int64_t>( ( record * 7 + 1000 ) % 2001 ) - 1000;
+   };
+   const auto cScaledRawValue = []( size_t record ) {
+      return static_cast<int64_t>( ( record * 37 ) % 200001 ) - 100000;
+   };
+   constexpr double cScale = 0.001;
+   constexpr double cOffset = 5.0;
+
+   {
+      e57::ImageFile imf( cFileName, "w" );
+
+      e57::StructureNode proto( imf );
+      proto.set( "int", e57::IntegerNode( imf, 0, -1000, 1000 ) );
+      proto.set( "scaled",
+                 e57::ScaledIntegerNode( imf, 0, -100000, 100000, cScale, cOffset ) );
+
+      e57::VectorNode codecs( imf, true );
+      e57::CompressedVectorNode cv( imf, proto, codecs );
+
+      imf.root().set( "points", cv );
+
+      std::vector<int64_t> ints( cIntNumRecords );
+      std::vector<int64_t> scaled( cIntNumRecords );
+
+      for ( size_t i = 0; i < cIntNumRecords; ++i )
+      {
+         ints[i] = cIntValue( i );
+         scaled[i] = cScaledRawValue( i );
+      }
+
+      std::vector<e57::SourceDestBuffer> sbufs{
+         { imf, "int", ints.data(), cIntNumRecords, true },
+         { imf, "scaled", scaled.data(), cIntNumRecords, true },
+      };
+
+      e57::CompressedVectorWriter writer = cv.writer( sbufs );
+
+      writer.write( cIntNumRecords );
+      writer.close();
+
+      imf.close();
+   }
+
+   e57::ImageFile imf( cFileName, "r" );
+   e57::CompressedVectorNode cv( imf.root().get( "points" ) );
+
+   {
+      // Types which hold every value, with and without scaling
+      std::vector<int16_t> ints( cIntNumRecords );
+      std::vector<double> intsAsDouble( cIntNumRecords );
+      std::vector<int32_t> scaledRaw( cIntNumRecords );
+      std::vector<double> scaled( cIntNumRecords );
+      std::vector<int8_t> scaledRounded( cIntNumRecords );
+
+      std::vector<e57::SourceDestBuffer> dbufs{
+         { imf, "int", ints.data(), cIntNumRecords, false },
+         { imf, "scaled", scaledRaw.data(), cIntNumRecords, false },
+      };
+      std::vector<e57::SourceDestBuffer> scaledDbufs{
+         { imf, "int", intsAsDouble.data(), cIntNumRecords, true },
+         { imf, "scaled", scaled.data(), cIntNumRecords, true, true },
+      };
+      std::vector<e57::SourceDestBuffer> roundedDbufs{
+         { imf, "scaled", scaledRounded.data(), cIntNumRecords, true, true },
+      };
+
+      for ( auto *buffers : { &dbufs, &scaledDbufs, &roundedDbufs } )
+      {
+         e57::CompressedVectorReader reader = cv.reader( *buffers );
+
+         ASSERT_EQ( reader.read(), static_cast<unsigned>( cIntNumRecords ) );
+
+         reader.close();
+      }
+
+      for ( size_t i = 0; i < cIntNumRecords; ++i )
+      {
+         const double cScaledValue = static_cast<double>( cScaledRawValue( i ) ) * cScale + cOffset;
+
+         ASSERT_EQ( ints[i], cIntValue( i ) ) << "record=" << i;
+         ASSERT_EQ( intsAsDouble[i], static_cast<double>( cIntValue( i ) ) ) << "record=" << i;
+         ASSERT_EQ( scaledRaw[i], cScaledRawValue( i ) ) << "record=" << i;
+         ASSERT_EQ( scaled[i], cScaledValue ) << "record=" << i;
+         ASSERT_EQ( scaledRounded[i], static_cast<int8_t>( std::floor( cScaledValue + 0.5 ) ) )
+            << "record=" << i;
+      }
+   }
+
+   {
+      // Values which don't fit are still reported
+      std::vector<int8_t> ints( cIntNumRecords );
+
+      std::vector<e57::SourceDestBuffer> dbufs{
+         { imf, "int", ints.data(), cIntNumRecords, false },
+      };
+
+      e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+      try
+      {
+         reader.read();
+
+         FAIL() << "read() did not report a value which doesn't fit";
+      }
+      catch ( const e57::E57Exception &e )
+      {
+         EXPECT_EQ( e.errorCode(), e57::ErrorValueNotRepresentable );
+      }
+
+      // Everything before it (record 19 is 133) was stored
+      EXPECT_EQ( ints[0], cIntValue( 0 ) );
+      EXPECT_EQ( ints[18], cIntValue( 18 ) );
+   }
+
+   {
+      // As are buffers which need a conversion that wasn't asked for
+      std::vector<float> ints( cIntNumRecords );
+
+      std::vector<e57::SourceDestBuffer> dbufs{
+         { imf, "int", ints.data(), cIntNumRecords, false },
+      };
+
+      e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+      try
+      {
+         reader.read();
+
+         FAIL() << "read() did not report the missing conversion";
+      }
+      catch ( const e57::E57Exception &e )
+      {
+         EXPECT_EQ( e.errorCode(), e57::ErrorConversionRequired );
+      }
+   }
+
+   imf.close();
+}
+
+TEST( CompressedVectorReader, SeekIndexedChunks )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-chunks.e57";
+
+   // Enough data for the writer to index many chunks
+   constexpr int64_t cChunkedNumRecords = 1500000;
+
+   {
+      e57::ImageFile imf( cFileName, "w" );
+
+      e57::StructureNode proto( imf );
+      proto.set( "y", e57::FloatNode( imf, 0.0, e57::PrecisionDouble ) );
+      proto.set( "intensity", e57::IntegerNode( imf, 0, 0, 1000 ) );
+
+      e57::VectorNode codecs( imf, true );
+      e57::CompressedVectorNode cv( imf, proto, codecs );
+
+      imf.root().set( "points", cv );
+
+      // Write in pieces which don't line up with the chunks
+      constexpr size_t cPieceSize = 99999;
+
+      std::vector<double> y( cPieceSize );
+      std::vector<int32_t> intensity( cPieceSize );
+
+      std::vector<e57::SourceDestBuffer> sbufs{
+         { imf, "y", y.data(), cPieceSize, true },
+         { imf, "intensity", intensity.data(), cPieceSize, true },
+      };
+
+      e57::CompressedVectorWriter writer = cv.writer( sbufs );
+
+      for ( int64_t first = 0; first < cChunkedNumRecords; first += cPieceSize )
+      {
+         const auto cCount =
+            static_cast<size_t>( std::min<int64_t>( cPieceSize, cChunkedNumRecords - first ) );
+
+         for ( size_t i = 0; i < cCount; ++i )
+         {
+            y[i] = static_cast<double>( first + i ) * 0.25;
+            intensity[i] = intensityValue( first + i );
+         }
+
+         writer.write( cCount );
+      }
+
+      writer.close();
+      imf.close();
+   }
+
+   e57::ImageFile imf( cFileName, "r" );
+   e57::CompressedVectorNode cv( imf.root().get( "points" ) );
+
+   std::vector<double> y( cBufferSize );
+   std::vector<int32_t> intensity( cBufferSize );
+
+   std::vector<e57::SourceDestBuffer> dbufs{
+      { imf, "y", y.data(), cBufferSize, true },
+      { imf, "intensity", intensity.data(), cBufferSize, true },
+   };
+
+   e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+   // Backwards through the file, so every seek has to go through the index
+   for ( int64_t record = cChunkedNumRecords - 1; record >= 0; record -= 50003 )
+   {
+      reader.seek( record );
+
+      const unsigned cCount = reader.read();
+
+      ASSERT_EQ( cCount, static_cast<unsigned>( std::min<int64_t>(
+                            cBufferSize, cChunkedNumRecords - record ) ) )
+         << "record=" << record;
+
+      for ( unsigned i = 0; i < cCount; ++i )
+      {
+         ASSERT_EQ( y[i], static_cast<double>( record + i ) * 0.25 ) << "record=" << record + i;
+         ASSERT_EQ( intensity[i], intensityValue( record + i ) ) << "record=" << record + i;
+      }
+   }
+
+   reader.close();
+   imf.close();
+}
+
+TEST( CompressedVectorReader, DecodeThreads )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-threads.e57";
+
+   writeRecords( cFileName );
+
+   e57::ImageFile imf( cFileName, "r" );
+   e57::CompressedVectorNode cv( imf.root().get( "points" ) );
+
+   std::vector<float> x( cBufferSize );
+   std::vector<int32_t> intensity( cBufferSize );
+   std::vector<int32_t> constant( cBufferSize );
+   std::vector<e57::ustring> name( cBufferSize );
+
+   std::vector<e57::SourceDestBuffer> dbufs{
+      { imf, "x", x.data(), cBufferSize, true },
+      { imf, "intensity", intensity.data(), cBufferSize, true },
+      { imf, "constant", constant.data(), cBufferSize, true },
+      { imf, "name", &name },
+   };
+
+   e57::CompressedVectorReader reader = cv.reader( dbufs );
+
+   EXPECT_EQ( reader.decodeThreadCount(), 1u );
+   E57_ASSERT_THROW( reader.setDecodeThreadCount( 0 ) );
+
+   reader.setDecodeThreadCount( 4 );
+
+   EXPECT_EQ( reader.decodeThreadCount(), 4u );
+
+   int64_t record = 0;
+
+   while ( const unsigned cCount = reader.read() )
+   {
+      for ( unsigned i = 0; i < cCount; ++i, ++record )
+      {
+         ASSERT_EQ( x[i], xValue( record ) ) << "record=" << record;
+         ASSERT_EQ( intensity[i], intensityValue( record ) ) << "record=" << record;
+         ASSERT_EQ( constant[i], 3 ) << "record=" << record;
+         ASSERT_EQ( name[i], nameValue( record ) ) << "record=" << record;
+      }
+   }
+
+   EXPECT_EQ( record, cNumRecords );
+
+   reader.close();
+   imf.close();
+}
+
+TEST( CompressedVectorReader, ReadParallel )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-parallel.e57";
+
+   // Enough records to be split into several ranges
+   constexpr int64_t cParallelNumRecords = 200000;
+
+   writeRecords( cFileName, cParallelNumRecords );
+
+   e57::ImageFile imf( cFileName, "r" );
+   e57::CompressedVectorNode cv( imf.root().get( "points" ) );
+
+   // Read into an array of structures, with room to spare
+   struct Record
+   {
+      float x;
+      int32_t intensity;
+      int32_t constant;
+   };
+
+   std::vector<Record> records( cParallelNumRecords + 10 );
+   std::vector<e57::ustring> name( cParallelNumRecords + 10 );
+
+   std::vector<e57::SourceDestBuffer> dbufs{
+      { imf, "x", &records[0].x, records.size(), true, false, sizeof( Record ) },
+      { imf, "intensity", &records[0].intensity, records.size(), true, false, sizeof( Record ) },
+      { imf, "constant", &records[0].constant, records.size(), true, false, sizeof( Record ) },
+      { imf, "name", &name },
+   };
+
+   ASSERT_EQ( cv.readParallel( dbufs, 4 ), static_cast<uint64_t>( cParallelNumRecords ) );
+
+   for ( int64_t i = 0; i < cParallelNumRecords; ++i )
+   {
+      ASSERT_EQ( records[i].x, xValue( i ) ) << "record=" << i;
+      ASSERT_EQ( records[i].intensity, intensityValue( i ) ) << "record=" << i;
+      ASSERT_EQ( records[i].constant, 3 ) << "record=" << i;
+      ASSERT_EQ( name[i], nameValue( i ) ) << "record=" << i;
+   }
+
+   // The readers are all closed again
+   EXPECT_EQ( imf.readerCount(), 0 );
+
+   imf.close();
+}
+
+TEST( CompressedVectorReader, ConcurrentReaders )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-concurrent.e57";
+   constexpr size_t cThreadCount = 4;
+
+   writeRecords( cFileName );
+
+   e57::ImageFile imf( cFileName, "r" );
+
+   const std::vector<int64_t> cGoodRecords = readOnThreads( imf, cThreadCount, cNumRecords );
+
+   for ( size_t t = 0; t < cThreadCount; ++t )
+   {
+      EXPECT_EQ( cGoodRecords[t], cNumRecords ) << "thread=" << t;
+   }
+
+   EXPECT_EQ( imf.readerCount(), 0 );
+
+   imf.close();
+}
+
+TEST( CompressedVectorReader, ConcurrentReadersLargeFile )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-concurrent-large.e57";
+   constexpr size_t cThreadCount = 4;
+
+   // Several MB, so the readers' packet prefetching (8 chunks of 64 pages, shared by all the
+   // readers of the file) can't hold what they all need at once
+   constexpr int64_t cLargeNumRecords = 300000;
+
+   writeRecords( cFileName, cLargeNumRecords );
+
+   // Read from the file with the default method (ReadMethodStream), which prefetches
+   e57::ImageFile imf( cFileName, "r" );
+
+   const std::vector<int64_t> cGoodRecords = readOnThreads( imf, cThreadCount, cLargeNumRecords );
+
+   for ( size_t t = 0; t < cThreadCount; ++t )
+   {
+      EXPECT_EQ( cGoodRecords[t], cLargeNumRecords ) << "thread=" << t;
+   }
+
+   EXPECT_EQ( imf.readerCount(), 0 );
+
+   imf.close();
+}
+
+TEST( CompressedVectorReader, TwoReadersPastAdviceWindow )
+{
+   const e57::ustring cFileName = "./CompressedVectorReader-advice-window.e57";
+
+   // More than 8 MB of data, so each reader moves through several of the 8 MB chunks it advises
+   // the OS about
+   constexpr int64_t cLargeNumRecords = 600000;
+
+   writeRecords( cFileName, cLargeNumRecords );
+
+   e57::ImageFile imf( cFileName, "r" );
+   e57::CompressedVectorNode cv( imf.root().get( "/points" ) );
+
+   struct Buffers
+   {
+      std::vector<float> x = std::vector<float>( cBufferSize );
+      std::vector<int32_t> intensity = std::vector<int32_t>( cBufferSize );
+      std::vector<e57::ustring> name = std::vector<e57::ustring>( cBufferSize );
+   };
+
+   Buffers buffers[2];
+   std::vector<e57::CompressedVectorReader> readers;
+
+   for ( auto &buffer : buffers )
+   {
+      std::vector<e57::SourceDestBuffer> dbufs{
+         { imf, "x", buffer.x.data(), cBufferSize, true },
+         { imf, "intensity", buffer.intensity.data(), cBufferSize, true },
+         { imf, "name", &buffer.name },
+      };
+
+      readers.push_back( cv.reader( dbufs ) );
+   }
+
+   ASSERT_EQ( imf.readerCount(), 2 );
+
+   // Read both readers in lockstep, so the second one is open whenever the first one moves into
+   // a new chunk (and so doesn't tell the OS to drop what the second one is about to read).
+   // Close the second reader halfway through so the rest is read with only one reader open.
+   int64_t records[2] = { 0, 0 };
+
+   while ( records[0] < cLargeNumRecords )
+   {
+      for ( size_t r = 0; r < readers.size(); ++r )
+      {
+         if ( !readers[r].isOpen() )
+         {
+            continue;
+         }
+
+         const unsigned cCount = readers[r].read();
+
+         ASSERT_GT( cCount, 0u ) << "reader=" << r << " record=" << records[r];
+
+         const Buffers &buffer = buffers[r];
+
+         for ( unsigned i = 0; i < cCount; ++i, ++records[r] )
+         {
+            ASSERT_EQ( buffer.x[i], xValue( records[r] ) )
+               << "reader=" << r << " record=" << records[r];
+            ASSERT_EQ( buffer.intensity[i], intensityValue( records[r] ) )
+               << "reader=" << r << " record=" << records[r];
+            ASSERT_EQ( buffer.name[i], nameValue( records[r] ) )
+               << "reader=" << r << " record=" << records[r];
+         }
+
+         if ( ( r == 1 ) && ( records[r] >= cLargeNumRecords / 2 ) )
+         {
+            readers[r].close();
+
+            EXPECT_EQ( imf.readerCount(), 1 );
+         }
+      }
+   }
+
+   EXPECT_EQ( records[0], cLargeNumRecords );
+   EXPECT_EQ( readers[0].read(), 0u );
+
+   readers[0].close();
+
+   EXPECT_EQ( imf.readerCount(), 0 );
+
+   imf.close();
+}
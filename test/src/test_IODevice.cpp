@@ -0,0 +1,132 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: BSL-1.0
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "E57SimpleReader.h"
+#include "E57SimpleWriter.h"
+
+#include "Helpers.h"
+#include "LatencyFileDevice.h"
+
+namespace
+{
+   constexpr int64_t cNumPoints = 5000;
+
+   void writePoints( e57::Writer &writer )
+   {
+      e57::Data3D header;
+      header.guid = "IODevice Header GUID";
+      header.pointCount = cNumPoints;
+      header.pointFields.cartesianXField = true;
+      header.pointFields.cartesianYField = true;
+      header.pointFields.cartesianZField = true;
+
+      e57::Data3DPointsFloat pointsData( header );
+
+      for ( int64_t i = 0; i < cNumPoints; ++i )
+      {
+         auto floati = static_cast<float>( i );
+         pointsData.cartesianX[i] = floati;
+         pointsData.cartesianY[i] = floati * 2.0f;
+         pointsData.cartesianZ[i] = floati * 3.0f;
+      }
+
+      writer.WriteData3DData( header, pointsData );
+   }
+
+   std::vector<char> fileContents( const e57::ustring &filePath )
+   {
+      std::ifstream stream( filePath, std::ios::binary );
+
+      return { std::istreambuf_iterator<char>( stream ), std::istreambuf_iterator<char>() };
+   }
+}
+
+TEST( IODevice, NullDevice )
+{
+   const std::shared_ptr<e57::IODevice> cDevice;
+
+   E57_ASSERT_THROW( e57::ImageFile( cDevice, "r" ) );
+   E57_ASSERT_THROW( e57::ImageFile( cDevice, "w" ) );
+}
+
+TEST( IODevice, WriteMatchesFile )
+{
+   e57::WriterOptions options;
+   options.guid = "IODevice File GUID";
+
+   {
+      e57::Writer writer( "./IODevice-file.e57", options );
+
+      writePoints( writer );
+   }
+
+   {
+      auto device =
+         std::make_shared<LatencyFileDevice>( "./IODevice-device.e57", LatencyFileDevice::Write );
+
+      e57::Writer writer( device, options );
+
+      writePoints( writer );
+
+      ASSERT_TRUE( writer.Close() );
+
+      EXPECT_GT( device->writeCount(), 0u );
+   }
+
+   const auto cFileContents = fileContents( "./IODevice-file.e57" );
+
+   ASSERT_FALSE( cFileContents.empty() );
+   EXPECT_EQ( cFileContents, fileContents( "./IODevice-device.e57" ) );
+}
+
+TEST( IODevice, ReadWithLatency )
+{
+   e57::WriterOptions options;
+   options.guid = "IODevice Latency GUID";
+
+   {
+      e57::Writer writer( "./IODevice-latency.e57", options );
+
+      writePoints( writer );
+   }
+
+   auto device = std::make_shared<LatencyFileDevice>(
+      "./IODevice-latency.e57", LatencyFileDevice::Read, std::chrono::microseconds( 100 ) );
+
+   e57::Reader reader( device, {} );
+
+   ASSERT_TRUE( reader.IsOpen() );
+   ASSERT_EQ( reader.GetData3DCount(), 1 );
+
+   e57::Data3D header;
+   ASSERT_TRUE( reader.ReadData3D( 0, header ) );
+   ASSERT_EQ( header.pointCount, cNumPoints );
+
+   e57::Data3DPointsFloat pointsData( header );
+
+   auto vectorReader = reader.SetUpData3DPointsData( 0, cNumPoints, pointsData );
+
+   uint64_t total = 0;
+
+   while ( const unsigned count = vectorReader.read() )
+   {
+      total += count;
+   }
+
+   vectorReader.close();
+
+   ASSERT_EQ( total, static_cast<uint64_t>( cNumPoints ) );
+   EXPECT_EQ( pointsData.cartesianY[cNumPoints - 1], static_cast<float>( cNumPoints - 1 ) * 2.0f );
+
+   // Runs of consecutive pages are read with one call, so there are fewer calls than pages read
+   const e57::IOStatistics cStats = reader.GetRawIMF().ioStatistics();
+
+   EXPECT_GT( device->readCount(), 0u );
+   EXPECT_LT( device->readCount(), cStats.pagesRead );
+}
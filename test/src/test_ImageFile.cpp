@@ -3,6 +3,7 @@
 
 #include <cstring>
 #include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -152,3 +153,53 @@ TEST( ImageFile, InvalidFileLength )
    const std::string cFileName = TestData::Path() + "/self/InvalidFileLength.e57";
    E57_ASSERT_THROW( imf = std::make_unique<e57::ImageFile>( cFileName, "r" ) );
 }
+
+// Check that the I/O statistics count what we write and read
+TEST( ImageFile, IOStatistics )
+{
+   const std::string cFileName = "./ImageFile-IOStatistics.e57";
+   std::vector<uint8_t> blobData( 100000, 0xAB );
+
+   {
+      e57::ImageFile imf( cFileName, "w" );
+
+      e57::BlobNode blob( imf, static_cast<int64_t>( blobData.size() ) );
+      imf.root().set( "blob", blob );
+
+      blob.write( blobData.data(), 0, blobData.size() );
+
+      imf.close();
+
+      const e57::IOStatistics cStats = imf.ioStatistics();
+
+      EXPECT_GT( cStats.writeCalls, 0u );
+      EXPECT_GE( cStats.pagesWritten, blobData.size() / 1020 );
+      EXPECT_GE( cStats.bytesCopied, blobData.size() );
+      EXPECT_EQ( cStats.pagesVerified, 0u );
+   }
+
+   e57::ImageFile imf( cFileName, "r" );
+
+   e57::BlobNode blob( imf.root().get( "blob" ) );
+   std::vector<uint8_t> buffer( blobData.size() );
+
+   blob.read( buffer.data(), 0, buffer.size() );
+
+   const e57::IOStatistics cFirstRead = imf.ioStatistics();
+
+   EXPECT_GT( cFirstRead.readCalls, 0u );
+   EXPECT_GE( cFirstRead.pagesRead, blobData.size() / 1020 );
+   EXPECT_GE( cFirstRead.pagesVerified, blobData.size() / 1020 );
+   EXPECT_EQ( buffer, blobData );
+
+   // Each page is only verified once
+   blob.read( buffer.data(), 0, buffer.size() );
+
+   const e57::IOStatistics cSecondRead = imf.ioStatistics();
+
+   EXPECT_GT( cSecondRead.pagesRead, cFirstRead.pagesRead );
+   EXPECT_EQ( cSecondRead.pagesVerified, cFirstRead.pagesVerified );
+   EXPECT_GT( cSecondRead.pagesNotVerified, cFirstRead.pagesNotVerified );
+
+   imf.close();
+}
@@ -0,0 +1,129 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: BSL-1.0
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "CheckedFile.h"
+#include "E57Exception.h"
+#include "Helpers.h"
+#include "Packet.h"
+
+namespace
+{
+   constexpr unsigned cNumPackets = 8;
+   constexpr unsigned cPacketSize = 64;
+
+   const e57::ustring cFileName = "./PacketReadCache.bin";
+
+   // Offset of packet i (packets can't start at 0)
+   uint64_t packetOffset( unsigned i )
+   {
+      return ( i + 1 ) * cPacketSize;
+   }
+
+   // Write a file of cNumPackets empty packets
+   void writePackets()
+   {
+      std::vector<char> data( packetOffset( cNumPackets ), 0 );
+
+      for ( unsigned i = 0; i < cNumPackets; ++i )
+      {
+         char *packet = &data[static_cast<size_t>( packetOffset( i ) )];
+
+         packet[0] = e57::EMPTY_PACKET;
+         packet[2] = cPacketSize - 1; // packetLogicalLengthMinus1 (little endian)
+      }
+
+      e57::CheckedFile file( cFileName, e57::CheckedFile::Write, e57::ChecksumAll );
+
+      file.write( data.data(), data.size() );
+      file.close();
+   }
+
+   // Lock packet i and return the number of pages it read (0 if it was in the cache). Pages are
+   // counted however they were read, e.g. from the io_uring read-ahead without any read calls.
+   uint64_t lockPacket( e57::CheckedFile &file, e57::PacketReadCache &cache, unsigned i )
+   {
+      const uint64_t cPagesRead = file.statistics().pagesRead;
+
+      const char *packet = nullptr;
+      auto lock = cache.lock( packetOffset( i ), packet );
+
+      EXPECT_EQ( packet[0], e57::EMPTY_PACKET );
+
+      return file.statistics().pagesRead - cPagesRead;
+   }
+}
+
+TEST( PacketReadCache, LeastRecentlyUsed )
+{
+   writePackets();
+
+   e57::CheckedFile file( cFileName, e57::CheckedFile::Read, e57::ChecksumAll );
+   e57::PacketReadCache cache( &file, 3 );
+
+   EXPECT_GT( lockPacket( file, cache, 0 ), 0u );
+   EXPECT_GT( lockPacket( file, cache, 1 ), 0u );
+   EXPECT_GT( lockPacket( file, cache, 2 ), 0u );
+
+   EXPECT_EQ( lockPacket( file, cache, 0 ), 0u );
+
+   // Evicts 1, the least recently used
+   EXPECT_GT( lockPacket( file, cache, 3 ), 0u );
+
+   EXPECT_EQ( lockPacket( file, cache, 0 ), 0u );
+   EXPECT_EQ( lockPacket( file, cache, 2 ), 0u );
+   EXPECT_EQ( lockPacket( file, cache, 3 ), 0u );
+   EXPECT_GT( lockPacket( file, cache, 1 ), 0u );
+}
+
+TEST( PacketReadCache, Resize )
+{
+   writePackets();
+
+   e57::CheckedFile file( cFileName, e57::CheckedFile::Read, e57::ChecksumAll );
+   e57::PacketReadCache cache( &file, 4 );
+
+   for ( unsigned i = 0; i < 4; ++i )
+   {
+      lockPacket( file, cache, i );
+   }
+
+   // Keeps the two most recently used
+   cache.resize( 2 );
+
+   EXPECT_EQ( cache.size(), 2u );
+   EXPECT_EQ( lockPacket( file, cache, 3 ), 0u );
+   EXPECT_EQ( lockPacket( file, cache, 2 ), 0u );
+
+   // Growing keeps everything
+   cache.resize( cNumPackets );
+
+   for ( unsigned i = 0; i < cNumPackets; ++i )
+   {
+      lockPacket( file, cache, i );
+   }
+
+   for ( unsigned i = 0; i < cNumPackets; ++i )
+   {
+      EXPECT_EQ( lockPacket( file, cache, i ), 0u );
+   }
+
+   E57_ASSERT_THROW( cache.resize( 0 ) );
+}
+
+TEST( PacketReadCache, OnlyOneLock )
+{
+   writePackets();
+
+   e57::CheckedFile file( cFileName, e57::CheckedFile::Read, e57::ChecksumAll );
+   e57::PacketReadCache cache( &file, 2 );
+
+   const char *packet = nullptr;
+   auto lock = cache.lock( packetOffset( 0 ), packet );
+
+   E57_ASSERT_THROW( cache.lock( packetOffset( 1 ), packet ) );
+   E57_ASSERT_THROW( cache.resize( 4 ) );
+}
@@ -1,9 +1,13 @@
 // libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
 // SPDX-License-Identifier: BSL-1.0
 
+#include <algorithm>
+#include <fstream>
+
 #include "gtest/gtest.h"
 
 #include "E57SimpleReader.h"
+#include "E57SimpleWriter.h"
 
 #include "Helpers.h"
 #include "TestData.h"
@@ -13,6 +17,134 @@ TEST( SimpleReader, PathError )
    E57_ASSERT_THROW( e57::Reader( "./no-path/empty.e57", {} ) );
 }
 
+TEST( SimpleReader, ReadData3DRange )
+{
+   const e57::ustring cFileName = "./SimpleReader-range.e57";
+   constexpr int64_t cNumPoints = 10000;
+
+   {
+      e57::WriterOptions options;
+      options.guid = "Range File GUID";
+
+      e57::Writer writer( cFileName, options );
+
+      e57::Data3D header;
+      header.guid = "Range Header GUID";
+      header.pointCount = cNumPoints;
+      header.pointFields.cartesianXField = true;
+      header.pointFields.cartesianYField = true;
+      header.pointFields.cartesianZField = true;
+
+      e57::Data3DPointsFloat pointsData( header );
+
+      for ( int64_t i = 0; i < cNumPoints; ++i )
+      {
+         auto floati = static_cast<float>( i );
+         pointsData.cartesianX[i] = floati;
+         pointsData.cartesianY[i] = floati * 2.0f;
+         pointsData.cartesianZ[i] = floati * 3.0f;
+      }
+
+      writer.WriteData3DData( header, pointsData );
+   }
+
+   e57::Reader reader( cFileName, {} );
+
+   e57::Data3D header;
+   ASSERT_TRUE( reader.ReadData3D( 0, header ) );
+
+   // Buffers for a window of the points
+   constexpr int64_t cWindowSize = 250;
+   header.pointCount = cWindowSize;
+
+   e57::Data3DPointsDouble pointsData( header );
+
+   for ( const int64_t cStart : { int64_t{ 4321 }, int64_t{ 0 }, cNumPoints - 100 } )
+   {
+      const size_t cCount = reader.ReadData3DRange( 0, cStart, cWindowSize, pointsData );
+
+      ASSERT_EQ( cCount, static_cast<size_t>( std::min( cWindowSize, cNumPoints - cStart ) ) );
+
+      for ( size_t i = 0; i < cCount; ++i )
+      {
+         ASSERT_EQ( pointsData.cartesianX[i], static_cast<double>( cStart + i ) );
+         ASSERT_EQ( pointsData.cartesianZ[i], static_cast<double>( cStart + i ) * 3.0 );
+      }
+   }
+
+   E57_ASSERT_THROW( reader.ReadData3DRange( 0, -1, cWindowSize, pointsData ) );
+}
+
+TEST( SimpleReader, BackgroundChecksumReportsBadPage )
+{
+   const e57::ustring cFileName = "./SimpleReader-background-checksum.e57";
+   constexpr int64_t cNumPoints = 10000;
+
+   {
+      e57::WriterOptions options;
+      options.guid = "Background Checksum File GUID";
+
+      e57::Writer writer( cFileName, options );
+
+      e57::Data3D header;
+      header.guid = "Background Checksum Header GUID";
+      header.pointCount = cNumPoints;
+      header.pointFields.cartesianXField = true;
+      header.pointFields.cartesianYField = true;
+      header.pointFields.cartesianZField = true;
+
+      e57::Data3DPointsFloat pointsData( header );
+
+      for ( int64_t i = 0; i < cNumPoints; ++i )
+      {
+         pointsData.cartesianX[i] = static_cast<float>( i );
+         pointsData.cartesianY[i] = 1.0f;
+         pointsData.cartesianZ[i] = 2.0f;
+      }
+
+      writer.WriteData3DData( header, pointsData );
+   }
+
+   // Corrupt one byte of point data in page 5 (well before the XML at the end of the file)
+   {
+      std::fstream stream( cFileName, std::ios::in | std::ios::out | std::ios::binary );
+
+      stream.seekg( 5 * 1024 + 100 );
+      const auto cByte = static_cast<char>( stream.get() );
+
+      stream.seekp( 5 * 1024 + 100 );
+      stream.put( static_cast<char>( cByte ^ 0x01 ) );
+   }
+
+   e57::ReaderOptions options;
+   options.checksumPolicy = e57::ChecksumBackground;
+
+   e57::Reader reader( cFileName, options );
+
+   e57::Data3D header;
+   ASSERT_TRUE( reader.ReadData3D( 0, header ) );
+
+   e57::Data3DPointsFloat pointsData( header );
+
+   // The bad checksum is found on another thread. It is reported by a later read or, at the
+   // latest, by Close(). (The Reader's destructor can't report it.)
+   try
+   {
+      auto vectorReader = reader.SetUpData3DPointsData( 0, cNumPoints, pointsData );
+
+      vectorReader.read();
+      vectorReader.close();
+
+      reader.Close();
+
+      FAIL() << "the bad checksum was not reported";
+   }
+   catch ( const e57::E57Exception &e )
+   {
+      EXPECT_EQ( e.errorCode(), e57::ErrorBadChecksum ) << e.context();
+   }
+}
+
 TEST( SimpleReaderData, Empty )
 {
    e57::Reader *reader = nullptr;
@@ -177,6 +309,14 @@ TEST( SimpleReaderData, DoNotCheckCRC )
       e57::Reader( TestData::Path() + "/self/bad-crc.e57", { e57::ChecksumNone } ) );
 }
 
+TEST( SimpleReaderData, BadCRCMemoryMapped )
+{
+   e57::ReaderOptions options;
+   options.readMethod = e57::ReadMethodMemoryMap;
+
+   E57_ASSERT_THROW( e57::Reader( TestData::Path() + "/self/bad-crc.e57", options ) );
+}
+
 // https://github.com/asmaloney/libE57Format/issues/26
 TEST( SimpleReaderData, ChineseFileName )
 {
@@ -265,6 +405,39 @@ TEST( SimpleReaderData, ColouredCubeFloatToDouble )
    delete reader;
 }
 
+TEST( SimpleReaderData, ColouredCubeFloatMemoryMapped )
+{
+   e57::ReaderOptions options;
+   options.readMethod = e57::ReadMethodMemoryMap;
+
+   e57::Reader *reader = nullptr;
+
+   E57_ASSERT_NO_THROW(
+      reader = new e57::Reader( TestData::Path() + "/self/ColouredCubeFloat.e57", options ) );
+
+   ASSERT_TRUE( reader->IsOpen() );
+   ASSERT_EQ( reader->GetData3DCount(), 1 );
+
+   e57::Data3D data3DHeader;
+   ASSERT_TRUE( reader->ReadData3D( 0, data3DHeader ) );
+
+   ASSERT_EQ( data3DHeader.pointCount, 7'680 );
+
+   const uint64_t cNumPoints = data3DHeader.pointCount;
+
+   e57::Data3DPointsFloat pointsData( data3DHeader );
+
+   auto vectorReader = reader->SetUpData3DPointsData( 0, cNumPoints, pointsData );
+
+   const uint64_t cNumRead = vectorReader.read();
+
+   vectorReader.close();
+
+   EXPECT_EQ( cNumRead, cNumPoints );
+
+   delete reader;
+}
+
 TEST( SimpleReaderData, BunnyDouble )
 {
    e57::Reader *reader = nullptr;
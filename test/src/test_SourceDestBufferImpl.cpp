@@ -0,0 +1,375 @@
+// libE57Format testing Copyright © 2022 Andy Maloney <asmaloney@gmail.com>
+// SPDX-License-Identifier: BSL-1.0
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "SourceDestBufferImpl.h"
+
+namespace
+{
+   const e57::ustring cFileName = "./SourceDestBufferImpl.e57";
+
+   constexpr double cScale = 0.01;
+   constexpr double cOffset = 3.0;
+
+   e57::ErrorCode errorFrom( const std::function<void()> &function )
+   {
+      try
+      {
+         function();
+      }
+      catch ( e57::E57Exception &ex )
+      {
+         return ex.errorCode();
+      }
+
+      return e57::Success;
+   }
+
+   // Transfer with single( buffer, i ) for each element of one buffer of T, and with
+   // block( buffer ) on another with the same contents, then check both buffers end up the same:
+   // contents, position, and error (if any). Elements are spacing Ts apart. Returns the number
+   // of elements transferred.
+   template <typename T, typename SingleFunction, typename BlockFunction>
+   size_t expectBlockMatchesSingle( e57::ImageFile &imf, const std::vector<T> &contents,
+                                  size_t spacing, bool doConversion, SingleFunction single,
+                                  BlockFunction block )
+   {
+      SCOPED_TRACE( "spacing=" + std::to_string( spacing ) );
+
+      // Not std::vector, because we need a bool *
+      std::unique_ptr<T[]> singleData( new T[contents.size()] );
+      std::unique_ptr<T[]> blockData( new T[contents.size()] );
+
+      std::copy( contents.begin(), contents.end(), singleData.get() );
+      std::copy( contents.begin(), contents.end(), blockData.get() );
+
+      const size_t cCount = contents.size() / spacing;
+
+      e57::SourceDestBuffer singleBuffer( imf, "x", singleData.get(), cCount, doConversion, true,
+                                          spacing * sizeof( T ) );
+      e57::SourceDestBuffer blockBuffer( imf, "x", blockData.get(), cCount, doConversion, true,
+                                         spacing * sizeof( T ) );
+
+      const e57::ErrorCode cSingleError = errorFrom( [&] {
+         for ( size_t i = 0; i < cCount; ++i )
+         {
+            single( *singleBuffer.impl(), i );
+         }
+      } );
+      const e57::ErrorCode cBlockError = errorFrom( [&] { block( *blockBuffer.impl() ); } );
+
+      EXPECT_EQ( cBlockError, cSingleError );
+      EXPECT_EQ( blockBuffer.impl()->nextIndex(), singleBuffer.impl()->nextIndex() );
+      EXPECT_TRUE(
+         std::equal( singleData.get(), singleData.get() + contents.size(), blockData.get() ) );
+
+      return singleBuffer.impl()->nextIndex();
+   }
+
+   // Values read before an error must match, the rest are unspecified
+   template <typename T>
+   void expectSameValues( const std::vector<T> &single, const std::vector<T> &block,
+                          size_t count )
+   {
+      EXPECT_TRUE( std::equal( single.begin(), single.begin() + count, block.begin() ) );
+   }
+
+   template <typename T>
+   void checkSetInt64( e57::ImageFile &imf, const std::vector<int64_t> &values,
+                       bool doConversion = true )
+   {
+      const size_t cCount = values.size();
+
+      for ( size_t spacing : { 1, 3 } )
+      {
+         const std::vector<T> cContents( cCount * spacing, T() );
+
+         expectBlockMatchesSingle(
+            imf, cContents, spacing, doConversion,
+            [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+               buffer.setNextInt64( values[i] );
+            },
+            [&]( e57::SourceDestBufferImpl &buffer ) {
+               buffer.setNextInt64Block( values.data(), cCount );
+            } );
+
+         expectBlockMatchesSingle(
+            imf, cContents, spacing, doConversion,
+            [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+               buffer.setNextInt64( values[i], cScale, cOffset );
+            },
+            [&]( e57::SourceDestBufferImpl &buffer ) {
+               buffer.setNextInt64Block( values.data(), cCount, cScale, cOffset );
+            } );
+
+         // Store functions picked for the range of the values, which leave out the range checks
+         // if every value fits
+         const auto cRange = std::minmax_element( values.begin(), values.end() );
+
+         for ( const bool cScaled : { false, true } )
+         {
+            expectBlockMatchesSingle(
+               imf, cContents, spacing, doConversion,
+               [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+                  if ( cScaled )
+                  {
+                     buffer.setNextInt64( values[i], cScale, cOffset );
+                  }
+                  else
+                  {
+                     buffer.setNextInt64( values[i] );
+                  }
+               },
+               [&]( e57::SourceDestBufferImpl &buffer ) {
+                  const auto cStore = buffer.int64BlockStore( cScaled, *cRange.first,
+                                                              *cRange.second, cScale, cOffset );
+
+                  cStore( buffer, values.data(), cCount, cScale, cOffset );
+               } );
+         }
+      }
+   }
+
+   void setNextReal( e57::SourceDestBufferImpl &buffer, float value )
+   {
+      buffer.setNextFloat( value );
+   }
+
+   void setNextReal( e57::SourceDestBufferImpl &buffer, double value )
+   {
+      buffer.setNextDouble( value );
+   }
+
+   void setNextRealBlock( e57::SourceDestBufferImpl &buffer, const float *values, size_t count )
+   {
+      buffer.setNextFloatBlock( values, count );
+   }
+
+   void setNextRealBlock( e57::SourceDestBufferImpl &buffer, const double *values, size_t count )
+   {
+      buffer.setNextDoubleBlock( values, count );
+   }
+
+   template <typename T, typename ValueT>
+   void checkSetReal( e57::ImageFile &imf, const std::vector<ValueT> &values,
+                      bool doConversion = true )
+   {
+      const size_t cCount = values.size();
+
+      for ( size_t spacing : { 1, 3 } )
+      {
+         expectBlockMatchesSingle(
+            imf, std::vector<T>( cCount * spacing, T() ), spacing, doConversion,
+            [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+               setNextReal( buffer, values[i] );
+            },
+            [&]( e57::SourceDestBufferImpl &buffer ) {
+               setNextRealBlock( buffer, values.data(), cCount );
+            } );
+      }
+   }
+
+   // Elements of contents are spacing Ts apart
+   template <typename T>
+   void checkGet( e57::ImageFile &imf, const std::vector<T> &contents, size_t spacing,
+                  bool doConversion = true )
+   {
+      const size_t cCount = contents.size() / spacing;
+
+      std::vector<int64_t> singleIntegers( cCount );
+      std::vector<int64_t> blockIntegers( cCount );
+
+      const size_t cReadIntegers = expectBlockMatchesSingle(
+         imf, contents, spacing, doConversion,
+         [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+            singleIntegers[i] = buffer.getNextInt64();
+         },
+         [&]( e57::SourceDestBufferImpl &buffer ) {
+            buffer.getNextInt64Block( blockIntegers.data(), cCount );
+         } );
+
+      expectSameValues( singleIntegers, blockIntegers, cReadIntegers );
+
+      const size_t cReadScaled = expectBlockMatchesSingle(
+         imf, contents, spacing, doConversion,
+         [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+            singleIntegers[i] = buffer.getNextInt64( cScale, cOffset );
+         },
+         [&]( e57::SourceDestBufferImpl &buffer ) {
+            buffer.getNextInt64Block( blockIntegers.data(), cCount, cScale, cOffset );
+         } );
+
+      expectSameValues( singleIntegers, blockIntegers, cReadScaled );
+
+      std::vector<float> singleFloats( cCount );
+      std::vector<float> blockFloats( cCount );
+
+      const size_t cReadFloats = expectBlockMatchesSingle(
+         imf, contents, spacing, doConversion,
+         [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+            singleFloats[i] = buffer.getNextFloat();
+         },
+         [&]( e57::SourceDestBufferImpl &buffer ) {
+            buffer.getNextFloatBlock( blockFloats.data(), cCount );
+         } );
+
+      expectSameValues( singleFloats, blockFloats, cReadFloats );
+
+      std::vector<double> singleDoubles( cCount );
+      std::vector<double> blockDoubles( cCount );
+
+      const size_t cReadDoubles = expectBlockMatchesSingle(
+         imf, contents, spacing, doConversion,
+         [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+            singleDoubles[i] = buffer.getNextDouble();
+         },
+         [&]( e57::SourceDestBufferImpl &buffer ) {
+            buffer.getNextDoubleBlock( blockDoubles.data(), cCount );
+         } );
+
+      expectSameValues( singleDoubles, blockDoubles, cReadDoubles );
+   }
+
+   template <typename T> std::vector<T> ramp( size_t count, double first, double step )
+   {
+      std::vector<T> values( count );
+
+      for ( size_t i = 0; i < count; ++i )
+      {
+         values[i] = static_cast<T>( first + ( i % 200 ) * step );
+      }
+
+      return values;
+   }
+}
+
+TEST( SourceDestBufferImpl, SetInt64Block )
+{
+   e57::ImageFile imf( cFileName, "w" );
+
+   const auto cSmall = ramp<int64_t>( 1000, -100, 1 );
+
+   // Doesn't fit in 8 bits, scaled or not, or in 16 bits unless scaled
+   auto large = cSmall;
+   large[700] = 40000;
+
+   for ( const auto &values : { cSmall, large } )
+   {
+      checkSetInt64<int8_t>( imf, values );
+      checkSetInt64<uint8_t>( imf, values );
+      checkSetInt64<int16_t>( imf, values );
+      checkSetInt64<uint16_t>( imf, values );
+      checkSetInt64<int32_t>( imf, values );
+      checkSetInt64<uint32_t>( imf, values );
+      checkSetInt64<int64_t>( imf, values );
+      checkSetInt64<bool>( imf, values );
+      checkSetInt64<float>( imf, values );
+      checkSetInt64<double>( imf, values );
+
+      // Integers are only stored in floating point buffers with conversion
+      checkSetInt64<float>( imf, values, false );
+   }
+
+   imf.close();
+}
+
+TEST( SourceDestBufferImpl, SetRealBlock )
+{
+   e57::ImageFile imf( cFileName, "w" );
+
+   const auto cSmall = ramp<double>( 1000, -100.25, 0.5 );
+
+   // Doesn't fit in 8, 16, or 32 bits
+   auto large = cSmall;
+   large[600] = 1.0e10;
+
+   for ( const auto &values : { cSmall, large } )
+   {
+      const std::vector<float> cFloats( values.begin(), values.end() );
+
+      checkSetReal<int8_t>( imf, values );
+      checkSetReal<int16_t>( imf, cFloats );
+      checkSetReal<uint32_t>( imf, values );
+      checkSetReal<int64_t>( imf, cFloats );
+      checkSetReal<bool>( imf, values );
+      checkSetReal<float>( imf, values );
+      checkSetReal<float>( imf, cFloats );
+      checkSetReal<double>( imf, values );
+      checkSetReal<double>( imf, cFloats );
+
+      // Floating point values are only stored in integer buffers with conversion
+      checkSetReal<int32_t>( imf, values, false );
+   }
+
+   // Doesn't fit in a float
+   auto infinite = cSmall;
+   infinite[300] = std::numeric_limits<double>::infinity();
+
+   checkSetReal<float>( imf, infinite );
+
+   imf.close();
+}
+
+TEST( SourceDestBufferImpl, GetBlock )
+{
+   e57::ImageFile imf( cFileName, "w" );
+
+   for ( size_t spacing : { 1, 2 } )
+   {
+      checkGet( imf, ramp<int8_t>( 1000, -100, 1 ), spacing );
+      checkGet( imf, ramp<uint16_t>( 1000, 0, 300 ), spacing );
+      checkGet( imf, ramp<int64_t>( 1000, -1.0e12, 1.0e10 ), spacing );
+      checkGet( imf, ramp<bool>( 1000, 0, 1 ), spacing );
+      checkGet( imf, ramp<float>( 1000, -100.25, 0.5 ), spacing );
+      checkGet( imf, ramp<double>( 1000, -1.0e6, 12345.678 ), spacing );
+
+      // Only floating point values can be read without conversion
+      checkGet( imf, ramp<int32_t>( 1000, -100, 1 ), spacing, false );
+      checkGet( imf, ramp<bool>( 1000, 0, 1 ), spacing, false );
+      checkGet( imf, ramp<double>( 1000, -100.25, 0.5 ), spacing, false );
+   }
+
+   // Too large for a float, or for an int64_t once the scaling is undone
+   auto huge = ramp<double>( 1000, -100.25, 0.5 );
+   huge[500] = std::numeric_limits<double>::infinity();
+
+   std::vector<float> singleFloats( huge.size() );
+   std::vector<float> blockFloats( huge.size() );
+
+   const size_t cReadFloats = expectBlockMatchesSingle(
+      imf, huge, 1, true,
+      [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+         singleFloats[i] = buffer.getNextFloat();
+      },
+      [&]( e57::SourceDestBufferImpl &buffer ) {
+         buffer.getNextFloatBlock( blockFloats.data(), huge.size() );
+      } );
+
+   expectSameValues( singleFloats, blockFloats, cReadFloats );
+
+   huge[500] = 1.0e30;
+
+   std::vector<int64_t> singleIntegers( huge.size() );
+   std::vector<int64_t> blockIntegers( huge.size() );
+
+   const size_t cReadIntegers = expectBlockMatchesSingle(
+      imf, huge, 1, true,
+      [&]( e57::SourceDestBufferImpl &buffer, size_t i ) {
+         singleIntegers[i] = buffer.getNextInt64( cScale, cOffset );
+      },
+      [&]( e57::SourceDestBufferImpl &buffer ) {
+         buffer.getNextInt64Block( blockIntegers.data(), huge.size(), cScale, cOffset );
+      } );
+
+   expectSameValues( singleIntegers, blockIntegers, cReadIntegers );
+
+   imf.close();
+}